@@ -0,0 +1,605 @@
+/*****************************************************************************
+* batch mode: solve many chains without starting a process for each one
+*
+* Each request is one line, which is exactly the arguments that would be
+* given to ./scallop, e.g.
+*   -cyclic -mGLPK a0b0 abAB
+* and each answer is one line of tab separated fields:
+*   <request line number> <status> <seconds> <scl> <last line of output>
+* where status is ok (an answer was printed), none (the command finished
+* without printing an answer, e.g. an LP error), exit (the command called
+* exit, e.g. bad input), or crash.  Answers are written as they finish,
+* so they may come back out of order.
+*
+* The engines write their answers to std::cout, and exlp and GLPK keep
+* global state, so the requests are solved by a pool of forked worker
+* processes rather than threads.  The workers are started once and reused;
+* a worker which exits or crashes is replaced.
+*
+* Requests which are the same up to the equivalences the engine knows 
+* about (for -cyclic, relabeling and inverting generators, and rotating, 
+* reordering and inverting words; see SCYLLA::canonical_command) are only 
+* solved once: the others wait for it, and a later equivalent request is 
+* answered at once if the first one printed an answer.  Only the status 
+* and the scl are shared: the output would show the first request's chain, 
+* so a shared answer has a time of 0 and "-" for its output.
+*****************************************************************************/
+
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <deque>
+#include <map>
+#include <thread>
+#include <chrono>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <signal.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/wait.h>
+
+#include "batch.h"
+
+
+struct BatchClient {
+  int in_fd;
+  int out_fd;
+  std::string buffer;     //partial request line
+  int line_number;
+  int pending;            //requests queued or being solved
+  bool eof;
+  bool closed;
+};
+
+struct BatchRequest {
+  int client;
+  int line_number;
+  std::string args;
+  std::string key;        //"" if it can't be shared
+};
+
+//requests waiting for an equivalent one to be solved, and the answers
+//to the ones which have been
+struct BatchShared {
+  std::map<std::string, std::vector<BatchRequest> > waiting;
+  std::map<std::string, std::string> answered;
+};
+
+struct BatchWorker {
+  pid_t pid;
+  int request_fd;
+  int result_fd;
+  bool busy;
+  bool dying;             //it answered "exit", so it's on its way out
+  BatchRequest request;
+  std::chrono::steady_clock::time_point start;
+  std::string buffer;     //partial answer line
+};
+
+
+/*****************************************************************************
+ * the worker side
+ * ***************************************************************************/
+static int worker_result_fd = -1;
+static std::ostringstream* worker_output = NULL;
+static std::streambuf* worker_cout_buf = NULL;
+static std::chrono::steady_clock::time_point worker_start;
+
+static double seconds_since(std::chrono::steady_clock::time_point start) {
+  return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+static bool write_all(int fd, const std::string& s) {
+  size_t done = 0;
+  while (done < s.size()) {
+    ssize_t n = write(fd, s.data() + done, s.size() - done);
+    if (n < 0) {
+      if (errno == EINTR) continue;
+      return false;
+    }
+    done += n;
+  }
+  return true;
+}
+
+//the answer fields after the line number, from what the command printed:
+//the scl is the value after the first " = " in the last line which has one
+//(the lines look like "scl_{a*b}( 1abAB ) = 1/2 = 0.5")
+static std::string batch_answer(std::string status,
+                                double seconds,
+                                const std::string& output) {
+  std::string line, answer_line, message;
+  std::istringstream lines(output);
+  while (std::getline(lines, line)) {
+    if (line.find_first_not_of(" \t\r") == std::string::npos) {
+      continue;
+    }
+    message = line;
+    if (line.find(" = ") != std::string::npos) {
+      answer_line = line;
+    }
+  }
+  std::string scl = "-";
+  if (answer_line != "") {
+    size_t start = answer_line.find(" = ") + 3;
+    size_t end = answer_line.find(" = ", start);
+    scl = answer_line.substr(start, (end == std::string::npos ? std::string::npos : end - start));
+  } else if (status == "ok") {
+    status = "none";
+  }
+  for (size_t i=0; i<message.size(); ++i) {
+    if (message[i] == '\t' || message[i] == '\r') {
+      message[i] = ' ';
+    }
+  }
+  std::ostringstream answer;
+  answer << status << "\t" << seconds << "\t" << scl << "\t" << message << "\n";
+  return answer.str();
+}
+
+//if the command calls exit, we still owe the parent an answer
+static void worker_exit_handler() {
+  if (worker_output == NULL) {
+    return;
+  }
+  std::cout.rdbuf(worker_cout_buf);
+  write_all(worker_result_fd, batch_answer("exit", seconds_since(worker_start), worker_output->str()));
+  worker_output = NULL;
+}
+
+static void batch_worker(int request_fd, int result_fd, ScallopCommand run) {
+  FILE* requests = fdopen(request_fd, "r");
+  char* line = NULL;
+  size_t line_cap = 0;
+  worker_result_fd = result_fd;
+  atexit(worker_exit_handler);
+  while (getline(&line, &line_cap, requests) > 0) {
+    std::istringstream words_in(line);
+    std::vector<std::string> words;
+    std::string word;
+    while (words_in >> word) {
+      words.push_back(word);
+    }
+    std::vector<std::vector<char> > arg_buffers(words.size());
+    std::vector<char*> args(words.size()+1, (char*)NULL);
+    for (int i=0; i<(int)words.size(); ++i) {
+      arg_buffers[i].assign(words[i].begin(), words[i].end());
+      arg_buffers[i].push_back('\0');
+      args[i] = &arg_buffers[i][0];
+    }
+
+    std::ostringstream output;
+    worker_output = &output;
+    worker_cout_buf = std::cout.rdbuf(output.rdbuf());
+    worker_start = std::chrono::steady_clock::now();
+    run((int)words.size(), &args[0]);
+    std::cout.rdbuf(worker_cout_buf);
+    worker_output = NULL;
+    if (!write_all(result_fd, batch_answer("ok", seconds_since(worker_start), output.str()))) {
+      break;
+    }
+  }
+  _exit(0);
+}
+
+
+/*****************************************************************************
+ * the parent side
+ * ***************************************************************************/
+//open_fds are the parent's other descriptors, which the worker shouldn't hold
+static bool spawn_worker(BatchWorker& W,
+                         std::vector<int>& open_fds,
+                         ScallopCommand run) {
+  int to_worker[2];
+  int from_worker[2];
+  if (pipe(to_worker) != 0) {
+    return false;
+  }
+  if (pipe(from_worker) != 0) {
+    close(to_worker[0]);
+    close(to_worker[1]);
+    return false;
+  }
+  std::cout.flush();
+  W.pid = fork();
+  if (W.pid < 0) {
+    close(to_worker[0]); close(to_worker[1]);
+    close(from_worker[0]); close(from_worker[1]);
+    return false;
+  }
+  if (W.pid == 0) {
+    close(to_worker[1]);
+    close(from_worker[0]);
+    for (int i=0; i<(int)open_fds.size(); ++i) {
+      close(open_fds[i]);
+    }
+    //anything not sent through std::cout (e.g. GLPK's messages) is dropped
+    int dev_null = open("/dev/null", O_RDWR);
+    dup2(dev_null, 0);
+    dup2(dev_null, 1);
+    close(dev_null);
+    signal(SIGPIPE, SIG_DFL);
+    batch_worker(to_worker[0], from_worker[1], run);
+  }
+  close(to_worker[0]);
+  close(from_worker[1]);
+  W.request_fd = to_worker[1];
+  W.result_fd = from_worker[0];
+  W.busy = false;
+  W.dying = false;
+  W.buffer = "";
+  return true;
+}
+
+static void answer_client(std::vector<BatchClient>& clients,
+                          const BatchRequest& R,
+                          const std::string& answer) {
+  BatchClient& client = clients[R.client];
+  client.pending--;
+  if (client.closed) {
+    return;
+  }
+  std::ostringstream line;
+  line << R.line_number << "\t" << answer;
+  if (!write_all(client.out_fd, line.str())) {
+    client.eof = true;
+  }
+}
+
+//the answer for a request equivalent to the one which was solved: the 
+//same status and scl, but no time or output of its own
+static std::string shared_answer(const std::string& answer) {
+  std::istringstream fields(answer);
+  std::string status, seconds, scl;
+  std::getline(fields, status, '\t');
+  std::getline(fields, seconds, '\t');
+  std::getline(fields, scl, '\t');
+  return status + "\t0\t" + scl + "\t-\n";
+}
+
+//answer a request which a worker solved, and everything waiting on it
+static void answer_solved(std::vector<BatchClient>& clients,
+                          BatchShared& shared,
+                          const BatchRequest& R,
+                          const std::string& answer) {
+  answer_client(clients, R, answer);
+  if (R.key == "") {
+    return;
+  }
+  std::string shared_line = shared_answer(answer);
+  std::vector<BatchRequest>& waiting = shared.waiting[R.key];
+  for (int i=0; i<(int)waiting.size(); ++i) {
+    answer_client(clients, waiting[i], shared_line);
+  }
+  shared.waiting.erase(R.key);
+  if (answer.compare(0, 3, "ok\t") == 0) {
+    shared.answered[R.key] = shared_line;
+  }
+}
+
+//queue a request, unless an equivalent one is queued, being solved, or done
+static void add_request(std::vector<BatchClient>& clients,
+                        BatchShared& shared,
+                        std::deque<BatchRequest>& queue,
+                        const BatchRequest& R) {
+  clients[R.client].pending++;
+  if (R.key != "") {
+    std::map<std::string, std::string>::iterator done = shared.answered.find(R.key);
+    if (done != shared.answered.end()) {
+      answer_client(clients, R, done->second);
+      return;
+    }
+    std::map<std::string, std::vector<BatchRequest> >::iterator it = shared.waiting.find(R.key);
+    if (it != shared.waiting.end()) {
+      it->second.push_back(R);
+      return;
+    }
+    shared.waiting[R.key] = std::vector<BatchRequest>(0);
+  }
+  queue.push_back(R);
+}
+
+//the key of a request line, split into words like the worker will
+static std::string request_key(const std::string& args, ScallopKey key) {
+  std::istringstream words_in(args);
+  std::vector<std::string> words;
+  std::string word;
+  while (words_in >> word) {
+    words.push_back(word);
+  }
+  std::vector<std::vector<char> > arg_buffers(words.size());
+  std::vector<char*> argv(words.size()+1, (char*)NULL);
+  for (int i=0; i<(int)words.size(); ++i) {
+    arg_buffers[i].assign(words[i].begin(), words[i].end());
+    arg_buffers[i].push_back('\0');
+    argv[i] = &arg_buffers[i][0];
+  }
+  return key((int)words.size(), &argv[0]);
+}
+
+//split off the complete request lines which have come in
+static void read_requests(std::vector<BatchClient>& clients,
+                          int client_index,
+                          BatchShared& shared,
+                          std::deque<BatchRequest>& queue,
+                          ScallopKey key,
+                          bool flush) {
+  BatchClient& client = clients[client_index];
+  size_t newline;
+  BatchRequest R;
+  R.client = client_index;
+  while ((newline = client.buffer.find('\n')) != std::string::npos ||
+         (flush && client.buffer.size() > 0)) {
+    if (newline == std::string::npos) {
+      newline = client.buffer.size();
+    }
+    R.args = client.buffer.substr(0, newline);
+    client.buffer.erase(0, newline+1);
+    client.line_number++;
+    R.line_number = client.line_number;
+    size_t first = R.args.find_first_not_of(" \t\r");
+    if (first == std::string::npos || R.args[first] == '#') {
+      continue;
+    }
+    R.key = request_key(R.args, key);
+    add_request(clients, shared, queue, R);
+  }
+}
+
+static void close_client(BatchClient& client) {
+  if (client.closed) {
+    return;
+  }
+  close(client.in_fd);
+  if (client.out_fd != client.in_fd) {
+    close(client.out_fd);
+  }
+  client.closed = true;
+}
+
+int batch(int argc, char** argv, ScallopCommand run, ScallopKey key) {
+  int i;
+  int current_arg = 0;
+  int num_workers = (int)std::thread::hardware_concurrency();
+  std::string socket_path = "";
+
+  while (current_arg < argc && argv[current_arg][0] == '-') {
+    if (std::string(argv[current_arg]) == "-socket" && current_arg+1 < argc) {
+      socket_path = std::string(argv[current_arg+1]);
+      current_arg++;
+    } else if (argv[current_arg][1] == 't') {
+      num_workers = atoi(&argv[current_arg][2]);
+    } else {
+      std::cout << "usage: ./scallop -batch [-h] [-t<n>] [-socket <path>]\n";
+      std::cout << "\tReads scallop commands one per line, e.g. \"-cyclic -mGLPK a0b0 abAB\", and\n";
+      std::cout << "\twrites one line per command as it finishes, with tab separated fields\n";
+      std::cout << "\t<request line number> <status> <seconds> <scl> <last line of output>\n";
+      std::cout << "\twhere status is ok, none (no answer was printed), exit (bad input), or crash\n";
+      std::cout << "\tA command equivalent to one already solved gets its status and scl, with\n";
+      std::cout << "\ttime 0 and output \"-\"\n";
+      std::cout << "\t-t<n>: solve with n worker processes (default: one per core)\n";
+      std::cout << "\t-socket <path>: serve connections on a unix socket at path instead\n";
+      std::cout << "\t                of reading stdin (each connection gets its own answers)\n";
+      return 0;
+    }
+    current_arg++;
+  }
+  if (num_workers < 1) {
+    num_workers = 1;
+  }
+
+  //a client hanging up shouldn't kill us
+  signal(SIGPIPE, SIG_IGN);
+
+  std::vector<BatchClient> clients(0);
+  BatchClient new_client;
+  new_client.buffer = "";
+  new_client.line_number = 0;
+  new_client.pending = 0;
+  new_client.eof = false;
+  new_client.closed = false;
+
+  int listen_fd = -1;
+  if (socket_path == "") {
+    new_client.in_fd = 0;
+    new_client.out_fd = 1;
+    clients.push_back(new_client);
+  } else {
+    struct sockaddr_un address;
+    memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    if (socket_path.size() >= sizeof(address.sun_path)) {
+      std::cout << "Socket path too long\n";
+      return 1;
+    }
+    strcpy(address.sun_path, socket_path.c_str());
+    unlink(socket_path.c_str());
+    listen_fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (listen_fd < 0 ||
+        bind(listen_fd, (struct sockaddr*)&address, sizeof(address)) != 0 ||
+        listen(listen_fd, 16) != 0) {
+      std::cout << "Couldn't listen on " << socket_path << ": " << strerror(errno) << "\n";
+      return 1;
+    }
+  }
+
+  std::vector<BatchWorker> workers(num_workers);
+  std::vector<int> open_fds(0);
+  if (listen_fd >= 0) {
+    open_fds.push_back(listen_fd);
+  }
+  for (i=0; i<num_workers; ++i) {
+    if (!spawn_worker(workers[i], open_fds, run)) {
+      std::cout << "Couldn't start a worker: " << strerror(errno) << "\n";
+      return 1;
+    }
+    open_fds.push_back(workers[i].request_fd);
+    open_fds.push_back(workers[i].result_fd);
+  }
+
+  std::deque<BatchRequest> queue;
+  BatchShared shared;
+  std::vector<struct pollfd> poll_fds;
+  std::vector<int> poll_owner;      //-1 listen, -2-i client i, i worker i
+  char read_buffer[4096];
+
+  while (true) {
+
+    //hand out requests to idle workers
+    for (i=0; i<num_workers && queue.size() > 0; ++i) {
+      if (workers[i].busy || workers[i].dying) {
+        continue;
+      }
+      workers[i].request = queue.front();
+      queue.pop_front();
+      workers[i].busy = true;
+      workers[i].start = std::chrono::steady_clock::now();
+      write_all(workers[i].request_fd, workers[i].request.args + "\n");
+    }
+
+    //hang up on clients which are done
+    bool all_done = true;
+    for (i=0; i<(int)clients.size(); ++i) {
+      if (clients[i].eof && clients[i].pending == 0) {
+        close_client(clients[i]);
+      }
+      if (!clients[i].closed) {
+        all_done = false;
+      }
+    }
+    if (listen_fd < 0 && all_done) {
+      break;
+    }
+
+    poll_fds.resize(0);
+    poll_owner.resize(0);
+    struct pollfd P;
+    P.events = POLLIN;
+    P.revents = 0;
+    if (listen_fd >= 0) {
+      P.fd = listen_fd;
+      poll_fds.push_back(P);
+      poll_owner.push_back(-1);
+    }
+    for (i=0; i<(int)clients.size(); ++i) {
+      if (clients[i].closed || clients[i].eof) {
+        continue;
+      }
+      P.fd = clients[i].in_fd;
+      poll_fds.push_back(P);
+      poll_owner.push_back(-2-i);
+    }
+    for (i=0; i<num_workers; ++i) {
+      P.fd = workers[i].result_fd;
+      poll_fds.push_back(P);
+      poll_owner.push_back(i);
+    }
+    if (poll(&poll_fds[0], poll_fds.size(), -1) < 0) {
+      if (errno == EINTR) continue;
+      std::cout << "poll failed: " << strerror(errno) << "\n";
+      break;
+    }
+
+    for (int p=0; p<(int)poll_fds.size(); ++p) {
+      if (poll_fds[p].revents == 0) {
+        continue;
+      }
+      int owner = poll_owner[p];
+
+      if (owner == -1) {
+        int fd = accept(listen_fd, NULL, NULL);
+        if (fd >= 0) {
+          new_client.in_fd = fd;
+          new_client.out_fd = fd;
+          clients.push_back(new_client);
+        }
+
+      } else if (owner <= -2) {
+        int c = -2-owner;
+        ssize_t n = read(clients[c].in_fd, read_buffer, sizeof(read_buffer));
+        if (n < 0 && errno == EINTR) {
+          continue;
+        }
+        if (n <= 0) {
+          clients[c].eof = true;
+          read_requests(clients, c, shared, queue, key, true);
+        } else {
+          clients[c].buffer.append(read_buffer, n);
+          read_requests(clients, c, shared, queue, key, false);
+        }
+
+      } else {
+        BatchWorker& W = workers[owner];
+        ssize_t n = read(W.result_fd, read_buffer, sizeof(read_buffer));
+        if (n < 0 && errno == EINTR) {
+          continue;
+        }
+        if (n > 0) {
+          W.buffer.append(read_buffer, n);
+          size_t newline = W.buffer.find('\n');
+          if (newline != std::string::npos && W.busy) {
+            answer_solved(clients, shared, W.request, W.buffer.substr(0, newline+1));
+            W.busy = false;
+            W.dying = (W.buffer.compare(0, 5, "exit\t") == 0);
+          }
+          if (newline != std::string::npos) {
+            W.buffer.erase(0, newline+1);
+          }
+          continue;
+        }
+
+        //the worker is gone; answer for it if it didn't, and replace it
+        int status;
+        waitpid(W.pid, &status, 0);
+        if (W.busy) {
+          std::ostringstream why;
+          if (WIFSIGNALED(status)) {
+            why << "killed by signal " << WTERMSIG(status) << "\n";
+          } else {
+            why << "exited with status " << WEXITSTATUS(status) << "\n";
+          }
+          answer_solved(clients, shared, W.request, batch_answer("crash", seconds_since(W.start), why.str()));
+          W.busy = false;
+        }
+        close(W.request_fd);
+        close(W.result_fd);
+        open_fds.resize(0);
+        if (listen_fd >= 0) {
+          open_fds.push_back(listen_fd);
+        }
+        for (i=0; i<(int)clients.size(); ++i) {
+          if (!clients[i].closed && clients[i].in_fd > 1) {
+            open_fds.push_back(clients[i].in_fd);
+          }
+        }
+        for (i=0; i<num_workers; ++i) {
+          if (i != owner) {
+            open_fds.push_back(workers[i].request_fd);
+            open_fds.push_back(workers[i].result_fd);
+          }
+        }
+        if (!spawn_worker(W, open_fds, run)) {
+          std::cout << "Couldn't restart a worker: " << strerror(errno) << "\n";
+          return 1;
+        }
+      }
+    }
+  }
+
+  //the workers quit when their request pipes close
+  for (i=0; i<num_workers; ++i) {
+    close(workers[i].request_fd);
+  }
+  for (i=0; i<num_workers; ++i) {
+    waitpid(workers[i].pid, NULL, 0);
+    close(workers[i].result_fd);
+  }
+  return 0;
+}
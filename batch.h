@@ -0,0 +1,17 @@
+#ifndef BATCH_H
+#define BATCH_H
+
+#include <string>
+
+//runs one scallop command: argv is what follows ./scallop on the command line
+typedef void (*ScallopCommand)(int argc, char** argv);
+
+//a key for a command: commands with the same key have the same scl, 
+//and "" means the command has to be run anyway
+typedef std::string (*ScallopKey)(int argc, char** argv);
+
+//./scallop -batch [options]: read scallop commands one per line and
+//solve them in a pool of worker processes (see batch.cc)
+int batch(int argc, char** argv, ScallopCommand run, ScallopKey key);
+
+#endif
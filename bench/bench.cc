@@ -0,0 +1,305 @@
+/*****************************************************************************
+* bench: time every engine on a fixed corpus of scallop commands
+*
+*   ./bench [-r<n>] [-o <baseline>] [-c <baseline>] [-s<percent>] [corpus]
+*
+* Each line of the corpus (default corpus.txt) is what would follow
+* ./scallop on the command line.  Every command is run n times (default 5)
+* in this process, through the same engine entry points as ./scallop, with
+* the output thrown away, and the median and 95th percentile wall time of
+* each phase (as recorded for -T) and of the whole command are reported.
+*
+* -o writes these to a baseline file, and -c compares against one: a phase
+* whose median is more than the given percent (default 20) and more than a
+* millisecond slower than its baseline is marked SLOWER, and if the total
+* time of any command is, bench exits with status 1.
+*
+* A command which calls exit (e.g. on bad input) ends the whole run, so
+* the corpus should only contain commands which succeed.
+*****************************************************************************/
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+
+#include "../scylla/scylla.h"
+#include "../gallop/gallop.h"
+#include "../trollop/trollop.h"
+#include "../scabble/scabble.h"
+#include "../hallop/hallop.h"
+#include "../stats.h"
+
+
+struct BenchEntry {
+  std::string command;
+  std::vector<std::string> phases;          //in order of appearance, then "total"
+  std::vector<std::vector<double> > times;  //times[phase][run]
+};
+
+struct BenchBaseline {
+  std::string command;
+  std::string phase;
+  double median;
+  double p95;
+};
+
+
+//the same dispatch as ./scallop (without -T, which is always on here)
+static void run_command(int argc, char** argv) {
+  if (argc < 1) {
+    return;
+  }
+  if (argv[0][0] != '-') {
+    GALLOP::gallop(argc, argv);
+  } else if (argv[0][1] == 't') {
+    TROLLOP::trollop(argc-1, &argv[1]);
+  } else if (argv[0][1] == 'l') {
+    GALLOP::gallop(argc-1, &argv[1]);
+  } else if (argv[0][1] == 'c') {
+    SCYLLA::scylla(argc-1, &argv[1]);
+  } else if (argv[0][1] == 'b') {
+    SCABBLE::scabble(argc-1, &argv[1]);
+  } else if (argv[0][1] == 'h') {
+    HALLOP::hallop(argc-1, &argv[1]);
+  } else {
+    GALLOP::gallop(argc, argv);
+  }
+}
+
+//run the command once, adding the time of each phase to the entry
+static void run_once(BenchEntry& E) {
+  std::istringstream words_in(E.command);
+  std::vector<std::string> words;
+  std::string word;
+  while (words_in >> word) {
+    words.push_back(word);
+  }
+  std::vector<std::vector<char> > arg_buffers(words.size());
+  std::vector<char*> args(words.size()+1, (char*)NULL);
+  for (int i=0; i<(int)words.size(); ++i) {
+    arg_buffers[i].assign(words[i].begin(), words[i].end());
+    arg_buffers[i].push_back('\0');
+    args[i] = &arg_buffers[i][0];
+  }
+
+  std::ostringstream output;
+  std::streambuf* cout_buf = std::cout.rdbuf(output.rdbuf());
+  std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+  STATS::start();
+  STATS::phase("parse");
+  run_command((int)words.size(), &args[0]);
+  STATS::stop();
+  double total = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  std::cout.rdbuf(cout_buf);
+
+  std::vector<std::string> names;
+  std::vector<double> wall_seconds;
+  STATS::phase_times(names, wall_seconds);
+  names.push_back("total");
+  wall_seconds.push_back(total);
+  for (int i=0; i<(int)names.size(); ++i) {
+    int j = std::find(E.phases.begin(), E.phases.end(), names[i]) - E.phases.begin();
+    if (j == (int)E.phases.size()) {
+      E.phases.push_back(names[i]);
+      E.times.push_back(std::vector<double>());
+    }
+    E.times[j].push_back(wall_seconds[i]);
+  }
+  //keep "total" last, even if a later run found a new phase
+  int t = std::find(E.phases.begin(), E.phases.end(), std::string("total")) - E.phases.begin();
+  if (t != (int)E.phases.size()-1) {
+    std::swap(E.phases[t], E.phases.back());
+    std::swap(E.times[t], E.times.back());
+  }
+}
+
+//nearest rank, so the median of an even number of runs is the lower one
+static double percentile(std::vector<double> times, double p) {
+  if ((int)times.size() == 0) {
+    return 0;
+  }
+  std::sort(times.begin(), times.end());
+  int rank = (int)ceil(p*times.size());
+  if (rank < 1) {
+    rank = 1;
+  }
+  return times[rank-1];
+}
+
+static bool read_corpus(const std::string& filename, std::vector<BenchEntry>& entries) {
+  std::ifstream in(filename.c_str());
+  if (!in.is_open()) {
+    return false;
+  }
+  std::string line;
+  while (std::getline(in, line)) {
+    if (line.find_first_not_of(" \t\r") == std::string::npos || line[0] == '#') {
+      continue;
+    }
+    BenchEntry E;
+    E.command = line.substr(0, line.find_last_not_of(" \t\r")+1);
+    entries.push_back(E);
+  }
+  return true;
+}
+
+//lines are command<TAB>phase<TAB>median<TAB>p95
+static bool read_baseline(const std::string& filename, std::vector<BenchBaseline>& baseline) {
+  std::ifstream in(filename.c_str());
+  if (!in.is_open()) {
+    return false;
+  }
+  std::string line;
+  while (std::getline(in, line)) {
+    if ((int)line.size() == 0 || line[0] == '#') {
+      continue;
+    }
+    std::vector<std::string> fields;
+    size_t start = 0;
+    size_t tab;
+    while ((tab = line.find('\t', start)) != std::string::npos) {
+      fields.push_back(line.substr(start, tab-start));
+      start = tab+1;
+    }
+    fields.push_back(line.substr(start));
+    if ((int)fields.size() != 4) {
+      continue;
+    }
+    BenchBaseline B;
+    B.command = fields[0];
+    B.phase = fields[1];
+    B.median = atof(fields[2].c_str());
+    B.p95 = atof(fields[3].c_str());
+    baseline.push_back(B);
+  }
+  return true;
+}
+
+static int find_baseline(std::vector<BenchBaseline>& baseline,
+                         const std::string& command,
+                         const std::string& phase) {
+  for (int i=0; i<(int)baseline.size(); ++i) {
+    if (baseline[i].command == command && baseline[i].phase == phase) {
+      return i;
+    }
+  }
+  return -1;
+}
+
+
+int main(int argc, char* argv[]) {
+  int repeats = 5;
+  double slower_percent = 20;
+  std::string corpus_file = "corpus.txt";
+  std::string out_file = "";
+  std::string compare_file = "";
+
+  int current_arg = 1;
+  while (current_arg < argc && argv[current_arg][0] == '-') {
+    if (argv[current_arg][1] == 'r') {
+      repeats = atoi(&argv[current_arg][2]);
+    } else if (argv[current_arg][1] == 's') {
+      slower_percent = atof(&argv[current_arg][2]);
+    } else if (argv[current_arg][1] == 'o' && current_arg+1 < argc) {
+      out_file = std::string(argv[current_arg+1]);
+      current_arg++;
+    } else if (argv[current_arg][1] == 'c' && current_arg+1 < argc) {
+      compare_file = std::string(argv[current_arg+1]);
+      current_arg++;
+    } else {
+      std::cout << "usage: ./bench [-h] [-r<n>] [-o <baseline>] [-c <baseline>] [-s<percent>] [corpus]\n";
+      std::cout << "\tRuns each scallop command in the corpus (default corpus.txt) n times and\n";
+      std::cout << "\treports the median and 95th percentile wall time of each phase\n";
+      std::cout << "\t-r<n>: run each command n times (default 5)\n";
+      std::cout << "\t-o <baseline>: write the times to a baseline file\n";
+      std::cout << "\t-c <baseline>: compare against a baseline file, and exit with status 1\n";
+      std::cout << "\t               if any command got slower\n";
+      std::cout << "\t-s<percent>: how much slower counts as slower (default 20)\n";
+      return 0;
+    }
+    current_arg++;
+  }
+  if (current_arg < argc) {
+    corpus_file = std::string(argv[current_arg]);
+  }
+  if (repeats < 1) {
+    repeats = 1;
+  }
+
+  std::vector<BenchEntry> entries(0);
+  if (!read_corpus(corpus_file, entries)) {
+    std::cout << "Couldn't read the corpus " << corpus_file << "\n";
+    return 1;
+  }
+  std::vector<BenchBaseline> baseline(0);
+  if (compare_file != "" && !read_baseline(compare_file, baseline)) {
+    std::cout << "Couldn't read the baseline " << compare_file << "\n";
+    return 1;
+  }
+
+  std::cout << std::fixed << std::setprecision(6);
+  int num_slower = 0;
+  bool total_slower = false;
+  for (int i=0; i<(int)entries.size(); ++i) {
+    BenchEntry& E = entries[i];
+    for (int r=0; r<repeats; ++r) {
+      run_once(E);
+    }
+    std::cout << "[" << i+1 << "] " << E.command << "\n";
+    for (int j=0; j<(int)E.phases.size(); ++j) {
+      double median = percentile(E.times[j], 0.5);
+      double p95 = percentile(E.times[j], 0.95);
+      std::cout << "    " << std::left << std::setw(12) << E.phases[j] << std::right
+                << " median " << median << "  p95 " << p95;
+      int b = find_baseline(baseline, E.command, E.phases[j]);
+      if (b >= 0) {
+        std::cout << "  baseline " << baseline[b].median;
+        if (baseline[b].median > 0) {
+          std::cout << "  x" << std::setprecision(2) << median / baseline[b].median
+                    << std::setprecision(6);
+        }
+        if (median > baseline[b].median * (1 + slower_percent/100)
+            && median - baseline[b].median > 0.001) {
+          std::cout << "  SLOWER";
+          num_slower++;
+          if (E.phases[j] == "total") {
+            total_slower = true;
+          }
+        }
+      }
+      std::cout << "\n";
+    }
+    std::cout.flush();
+  }
+
+  if (compare_file != "") {
+    std::cout << num_slower << " phases slower than the baseline\n";
+  }
+
+  if (out_file != "") {
+    std::ofstream out(out_file.c_str());
+    if (!out.is_open()) {
+      std::cout << "Couldn't write the baseline " << out_file << "\n";
+      return 1;
+    }
+    out << std::setprecision(9);
+    out << "# scallop bench baseline (" << repeats << " runs): command, phase, median, p95\n";
+    for (int i=0; i<(int)entries.size(); ++i) {
+      for (int j=0; j<(int)entries[i].phases.size(); ++j) {
+        out << entries[i].command << "\t" << entries[i].phases[j] << "\t"
+            << percentile(entries[i].times[j], 0.5) << "\t"
+            << percentile(entries[i].times[j], 0.95) << "\n";
+      }
+    }
+    std::cout << "Wrote baseline to " << out_file << "\n";
+  }
+
+  return (total_slower ? 1 : 0);
+}
@@ -29,6 +29,7 @@ typedef struct {
   int* ptr;
 } EXLPvector_d;
 
+void vector_block_resize(EXLPvector* vec, int blocks);
 void vector_init(EXLPvector* vec, int dimension);
 EXLPvector* new_vector(int dimension);
 void vector_free(EXLPvector** vec);
@@ -59,6 +60,7 @@ void vector_swap_elements(EXLPvector* vec, int i1, int i2);
 void vector_print(EXLPvector* vec);
 int vector_check(EXLPvector* vec);
 
+void vector_d_block_resize(EXLPvector_d* vec, int blocks);
 EXLPvector_d* new_vector_d(int dimension);
 void vector_d_free(EXLPvector_d** v_d);
 void vector_d_resize(EXLPvector_d* vec, int dimension);
@@ -181,12 +181,15 @@ void lp_remove_row(LP* lp, int row) {
     lp->is_basis[lp->basis_column[row]] = FALSE;
   lp->rows --;
   for (i = row; i < lp->rows; i ++) {
-    strncpy(lp->row_name[i], lp->row_name[i+1], LP_NAME_LEN_MAX);
+    if (lp->row_name != NULL)
+      strncpy(lp->row_name[i], lp->row_name[i+1], LP_NAME_LEN_MAX);
     lp->row_equality[i] = lp->row_equality[i+1];
     lp->basis_column[i] = lp->basis_column[i+1];
   }
-  free(lp->row_name[lp->rows]);
-  lp->row_name = my_realloc(lp->row_name, lp->rows*sizeof(char*));
+  if (lp->row_name != NULL) {
+    free(lp->row_name[lp->rows]);
+    lp->row_name = my_realloc(lp->row_name, lp->rows*sizeof(char*));
+  }
   lp->row_equality = my_realloc(lp->row_equality, lp->rows*sizeof(int));
   lp->basis_column = my_realloc(lp->basis_column, lp->rows*sizeof(int));
 }
@@ -316,6 +319,66 @@ void lp_hash_str_init(LP *lp, int hash_entries) {
   lp->hash_str_var_name = hash_str_init(hash_entries);
 }
 
+void lp_load_csc(LP* lp, int rows, int columns,
+                 int* col_start, int* row_index, int* value,
+                 int* obj, int* rhs) {
+  /* Loads a whole problem by index into a fresh lp, with no row or
+     variable names: all rows are LP_EQUALITY_EQ and all variables are
+     >= 0.  The entries of column j are (row_index[k], value[k]) for
+     col_start[j] <= k < col_start[j+1]; a row must not repeat within
+     a column.  c is set to obj as given (so negate it for a
+     minimization).  obj and rhs may be NULL. */
+  EXLPvector*   col;
+  EXLPvector_d* row;
+  int*  row_count;
+  int   i, j, k;
+
+  lp_resize(lp, rows, columns, FALSE);
+
+  /* size the row and column vectors once, rather than block by block */
+  row_count = my_calloc(rows+1, sizeof(int));
+  for (k = 0; k < col_start[columns]; k ++)
+    row_count[row_index[k]] ++;
+  for (i = 0; i < rows; i ++)
+    vector_d_block_resize(lp->A->row[i], row_count[i]/VECTOR_BLOCK_SIZE+1);
+  free(row_count);
+
+  for (j = 0; j < columns; j ++) {
+    col = lp->A->column[j];
+    vector_block_resize(col, (col_start[j+1]-col_start[j])/VECTOR_BLOCK_SIZE+1);
+    for (k = col_start[j]; k < col_start[j+1]; k ++) {
+      if (value[k] == 0)
+        continue;
+      i = row_index[k];
+      mpq_set_si(col->value[col->nonzeros], value[k], 1);
+      col->i[col->nonzeros] = i;
+      col->ptr[i] = col->nonzeros ++;
+      row = lp->A->row[i];
+      row->value[row->nonzeros] = 1;
+      row->i[row->nonzeros] = j;
+      row->ptr[j] = row->nonzeros ++;
+    }
+  }
+
+  if (obj != NULL) {
+    for (j = 0; j < columns; j ++) {
+      if (obj[j] == 0)
+        continue;
+      mpq_set_si(lp->q_work, obj[j], 1);
+      vector_set_element(lp->c, lp->q_work, j);
+    }
+  }
+
+  if (rhs != NULL) {
+    for (i = 0; i < rows; i ++) {
+      if (rhs[i] == 0)
+        continue;
+      mpq_set_si(lp->q_work, rhs[i], 1);
+      vector_set_element(lp->b, lp->q_work, i);
+    }
+  }
+}
+
 int lp_get_row_num(LP* lp, char* name) {
   if (strncmp(lp->obj_name, name, LP_NAME_LEN_MAX) == 0)
     return lp->rows;
@@ -146,4 +146,8 @@ void lp_LU_basis(LP* lp);
 
 void lp_hash_str_init(LP* lp, int hash_entries);
 
+void lp_load_csc(LP* lp, int rows, int columns,
+                 int* col_start, int* row_index, int* value,
+                 int* obj, int* rhs);
+
 #endif
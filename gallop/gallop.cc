@@ -4,12 +4,17 @@
 #include <cctype>
 #include <cstdlib>
 #include <cstdio>
+#include <thread>
+#include <atomic>
+#include <iterator>
+#include <set>
 
 #include "gallop.h"
 #include "graph.h"
 #include "../rational.h"
 #include "../lp.h"
 #include "../word.h"
+#include "../stats.h"
 
 
 using namespace GALLOP;
@@ -167,147 +172,279 @@ void GALLOP::local_condition_test::pop_rect(Chain& C, RectList& RL, Poly& temp_p
 
 
 
+//for column generation: the polygons wanted are those whose rectangles 
+//have total weight less than threshold (i.e. negative reduced cost), 
+//and which aren't in the LP already
+template <typename T>
+struct PolyPricer {
+  int num_rects;
+  std::vector<T> weight;                     //weight[si + num_rects] for the signed rectangle si
+  std::vector<std::vector<T> > bound;        //bound[k][letter] is at most the weight of
+  std::vector<std::vector<bool> > has_bound; //any k or fewer rectangles starting at letter
+  T threshold;
+  std::set<std::vector<int> >* existing;
+  int max_found;                             //stop a search after finding this many
+  
+  T& w(int si) { return weight[si + num_rects]; }
+};
+
+//all the polygons whose first (and smallest) rectangle is first_rect, in 
+//the order the search has always produced them (or, with a pricer, just 
+//the ones it wants).  The stack only holds a cursor into the list of 
+//rectangles starting at each letter, so nothing is copied as the search 
+//goes deeper
+template <typename T>
+static void polys_starting_with(Chain& C, 
+                                RectList& RL, 
+                                int first_rect,
+                                int valence,
+                                int max_rects,
+                                bool require_folded,
+                                bool ffolded,
+                                PolyPricer<T>* pricer,
+                                int verbose,
+                                std::vector<Poly>& out) {
+  bool do_tester = require_folded || ffolded;
+  local_condition_test LCT(require_folded, ffolded);
+  Poly temp_poly;
+  std::vector<T> sums(0);        //the weight of temp_poly up to each rectangle
+  int ind, sign;
+  int first_letter, second_letter, next_letter;
+  int r, d, left;
+  
+  if (do_tester) {
+    LCT.new_vertex(valence);
+    if (!LCT.test_new_rect(C, RL, temp_poly, first_rect, verbose)) {
+      return;
+    }
+    LCT.add_rect(C, RL, temp_poly, first_rect);
+  }
+  temp_poly.rects.push_back(first_rect);
+  extract_signed_index(first_rect, &ind, &sign);
+  first_letter = (sign < 0 ? RL.r[ind].second : RL.r[ind].first);
+  second_letter = (sign < 0 ? RL.r[ind].first : RL.r[ind].second);
+  next_letter = C.next_letter(second_letter);
+  if (pricer != NULL) {
+    sums.push_back(pricer->w(first_rect));
+  }
+  if (next_letter == first_letter) {
+    if (pricer == NULL || (is_negative(sums[0] - pricer->threshold)
+                           && pricer->existing->count(temp_poly.rects) == 0)) {
+      out.push_back(temp_poly);
+    }
+    return;
+  }
+  if (max_rects == 1) {
+    return;
+  }
+  if (pricer != NULL && (!pricer->has_bound[max_rects-1][next_letter] 
+                         || !is_negative(sums[0] + pricer->bound[max_rects-1][next_letter] 
+                                         - pricer->threshold))) {
+    return;
+  }
+  
+  //choices[d] is the list for rectangle d+1, which is gone through from 
+  //the back, and cursor[d] is how much of it is left
+  std::vector<const int*> choices(1, RL.starting_with(next_letter));
+  std::vector<int> cursor(1, RL.num_starting_with(next_letter));
+  while ((int)cursor.size() > 0) {
+    d = (int)cursor.size()-1;
+    
+    if (verbose > 3) {
+      std::cout << "Current rect: " << d+1 << " with " << cursor[d] << " choices left\n";
+      std::cout << "Current temp_poly: " << temp_poly << "\n";
+    }
+    
+    //out of choices, so back up
+    if (cursor[d] == 0) {
+      choices.pop_back();
+      cursor.pop_back();
+      if (d > 0) {
+        if (do_tester) LCT.pop_rect(C, RL, temp_poly);
+        temp_poly.rects.pop_back();
+        if (pricer != NULL) sums.pop_back();
+      }
+      if (verbose>3) std::cout << "backing up\n";
+      continue;
+    }
+    r = choices[d][--cursor[d]];
+    
+    //if the potential choice has a smaller index, forget it
+    if (r < first_rect) {
+      if (verbose>3) std::cout << "next rect too small\n";
+      continue;
+    }
+    if (do_tester) {
+      if (!LCT.test_new_rect(C, RL, temp_poly, r, verbose)) {
+        if (verbose > 3) std::cout << "next rect would violate tester\n";
+        continue;
+      }
+      LCT.add_rect(C, RL, temp_poly, r);
+    }
+    temp_poly.rects.push_back(r);
+    if (pricer != NULL) {
+      sums.push_back(sums.back() + pricer->w(r));
+    }
+    
+    extract_signed_index(r, &ind, &sign);
+    second_letter = (sign < 0 ? RL.r[ind].first : RL.r[ind].second);
+    next_letter = C.next_letter(second_letter);
+    left = max_rects - (int)temp_poly.rects.size();
+    if (next_letter == first_letter) {            //the polygon can close up
+      if (verbose > 3) std::cout << "This one is good: " << temp_poly << "\n";
+      if (pricer == NULL) {
+        out.push_back(temp_poly);
+      } else if (is_negative(sums.back() - pricer->threshold)
+                 && pricer->existing->count(temp_poly.rects) == 0) {
+        out.push_back(temp_poly);
+        if ((int)out.size() >= pricer->max_found) {
+          return;
+        }
+      }
+    } else if (left > 0 
+               && (pricer == NULL 
+                   || (pricer->has_bound[left][next_letter]
+                       && is_negative(sums.back() + pricer->bound[left][next_letter] 
+                                      - pricer->threshold)))) {
+      //the polygon doesn't close up, and it may be worth going on
+      choices.push_back(RL.starting_with(next_letter));
+      cursor.push_back(RL.num_starting_with(next_letter));
+      if (verbose>3) std::cout << "added a new option\n";
+      continue;
+    }
+    //this rectangle is done with
+    if (do_tester) LCT.pop_rect(C, RL, temp_poly);
+    temp_poly.rects.pop_back();
+    if (pricer != NULL) sums.pop_back();
+  }
+}
+
+//one search for each vertex and first rectangle; these are handed out 
+//one at a time, so a vertex with high valence is spread over the threads
+struct PolySearch {
+  int vertex;
+  int first_rect;
+  int max_rects;
+};
+
+template <typename T>
+static void polys_worker(Chain *C, 
+                         RectList *RL, 
+                         std::vector<PolySearch> *searches,
+                         bool require_folded,
+                         bool ffolded,
+                         PolyPricer<T>* pricer,
+                         int verbose,
+                         std::atomic<int> *next_search,
+                         std::vector<std::vector<Poly> > *by_search) {
+  int i;
+  int num_searches = (int)searches->size();
+  while ((i = (*next_search)++) < num_searches) {
+    PolySearch &S = (*searches)[i];
+    polys_starting_with(*C, *RL, S.first_rect, 
+                        (int)C->G->verts[S.vertex].incident_edges.size(), 
+                        S.max_rects, require_folded, ffolded, pricer, verbose, 
+                        (*by_search)[i]);
+  }
+}
+
+//all the polygons (or, with a pricer, the ones it wants, which are 
+//appended to P) with at most max_polygon_valence sides (or the vertex 
+//valence, if that's not positive)
+template <typename T>
 void compute_polys(std::vector<Poly>& P, 
                    RectList& RL, 
                    Chain& C, 
                    bool require_folded,
                    int require_f_folded,
                    int max_polygon_valence,
+                   int num_threads,
+                   PolyPricer<T>* pricer,
                    int verbose) {
-  P.resize(0);
-  Poly temp_poly;
+  if (pricer == NULL) {
+    P.resize(0);
+  }
   Graph* G = C.G;
-  std::vector<std::vector<int> > rect_choices(1);
+  std::vector<int> first_choices(0);
+  std::vector<PolySearch> searches(0);
+  PolySearch S;
   int gen;
-  int ind;
   int sign;
-  int current_rect; //the current polygon length
-  int first_letter;
-  int next_letter, second_letter;
-  int i,j,k,m,n;
-  int max_rects;
-  int valence;
+  int i,j,k,t,L;
   bool ffolded = (bool)require_f_folded;
-  bool do_tester = require_folded || ffolded;
-  
-  local_condition_test LCT(require_folded, ffolded);
   
   for (i=0; i<G->num_verts; i++) {
     
     if (verbose > 3) std::cout << "Running vertex " << i << "\n";
     
-    valence = G->verts[i].incident_edges.size();
-    
+    S.vertex = i;
     if (max_polygon_valence > 0) {
-      max_rects = max_polygon_valence;
-    } else if (require_f_folded) {
-      max_rects = valence;
+      S.max_rects = max_polygon_valence;
     } else {
-      max_rects = valence;
+      S.max_rects = G->verts[i].incident_edges.size();
     }
     
-    //initialize the local tester
-    if (do_tester) LCT.new_vertex(G->verts[i].incident_edges.size());
-  
-    //build all polys at this vertex
     //we may assume that the signed index of the starting rectangle is
-    //the smallest
-    rect_choices.resize(1);
-    rect_choices[0].resize(0);
+    //the smallest.  The choices have always been taken from the back
+    first_choices.resize(0);
     for (j=0; j<(int)G->verts[i].incident_edges.size(); j++) {
       gen = G->verts[i].incident_edges[j];
       sign = (G->verts[i].is_outgoing[j] ? 0 : 1);
       for (k=0; k<(int)C.CLs_from_gen[2*gen+sign].size(); k++) {
-        extend_vector(rect_choices[0], 
-                      RL.rects_starting_with[C.CLs_from_gen[2*gen+sign][k]] );
+        L = C.CLs_from_gen[2*gen+sign][k];
+        first_choices.insert(first_choices.end(), RL.starting_with(L), 
+                             RL.starting_with(L) + RL.num_starting_with(L));
       }
     }
-    
-    current_rect = 0;
-    temp_poly.rects.resize(0);
-    while (rect_choices[0].size() != 0 || rect_choices.size() > 1) {
-      
-      if (verbose > 3) {
-        std::cout << "Current rect: " << current_rect << "\n";
-        std::cout << "Current polygon stack:\n";
-        for (m=0; m<(int)rect_choices.size(); m++) {
-          std::cout << m << ": ";
-          for (n=0; n<(int)rect_choices[m].size(); n++) {
-            std::cout << rect_choices[m][n] << " ";
-          }
-          std::cout << "\n";
-        }
-        std::cout << "Current temp_poly: " << temp_poly << "\n";
-      }      
-      
-      //are we dealing with an empty choice?  If so, back up
-      if (rect_choices[current_rect].size() == 0) {
-        current_rect--;
-        rect_choices.pop_back();
-        if (do_tester) LCT.pop_rect(C, RL, temp_poly);      //we're about to back up -- if require_folded, un-check this edge
-        temp_poly.rects.pop_back();
-        if (verbose>3) std::cout << "backing up\n";
-        continue;
-      } else {
-        //if the potential choice has a smaller index, forget it
-        if (current_rect > 0 && rect_choices[current_rect].back() < temp_poly.rects[0]) {
-          rect_choices[current_rect].pop_back();
-          if (verbose>3) std::cout << "next rect too small\n";
-          continue;
-        }
-        //do the local test
-        if (do_tester) {
-          if (LCT.test_new_rect(C, RL, temp_poly, rect_choices[current_rect].back(), verbose)) {
-            LCT.add_rect(C, RL, temp_poly, rect_choices[current_rect].back());
-          } else {
-            if (verbose > 3) std::cout << "next rect would violate tester\n";
-            rect_choices[current_rect].pop_back();
-            continue;
-          }
-        } 
-        temp_poly.rects.push_back( rect_choices[current_rect].back() );
-        rect_choices[current_rect].pop_back();
-      }
-      //can we add a rectangle?
-      extract_signed_index(temp_poly.rects[current_rect], &ind, &sign);
-      second_letter = ( sign < 0 ? RL.r[ind].first : RL.r[ind].second);
-      next_letter = C.next_letter(second_letter);
-      //if this rectangle is the 0th one, then we need to reset the first_letter
-      if (current_rect == 0) {
-        first_letter = (sign < 0 ? RL.r[ind].second : RL.r[ind].first);
-      }
-      if (next_letter == first_letter) {               //the polygon can close up
-        //add this polygon
-        //but only if the valence is correct
-        if (verbose > 3) std::cout << "This one is good: " << temp_poly << "\n";
-        //if (require_trivalent) {
-        //  if (temp_poly.rects.size() == 3 || valence < 3) {
-        //    P.push_back(temp_poly);
-        //  }
-        //} else {
-          P.push_back(temp_poly);
-        //}
-        if (do_tester) LCT.pop_rect(C, RL, temp_poly); //we're about to back up -- if require_folded, un-check this edge
-        temp_poly.rects.pop_back();
-        continue;
-      } 
-      //the polygon doesn't close up, so add on the next set of rectangle options
-      //if the length isn't too big
-      if (current_rect+1 == max_rects) {        
-        //we're about to back up -- if require_folded, un-check this edge
-        if (do_tester) LCT.pop_rect(C, RL, temp_poly);
-        temp_poly.rects.pop_back();
-        if (verbose>3) std::cout << "sized maxed out -- backing up\n";
-        continue;
-      } else {    
-        rect_choices.resize(current_rect+2);
-        rect_choices[current_rect+1] = RL.rects_starting_with[next_letter];
-        current_rect++;
-        if (verbose>3) std::cout << "added a new option\n";
-        continue;
-      }
+    for (j=(int)first_choices.size()-1; j>=0; j--) {
+      S.first_rect = first_choices[j];
+      searches.push_back(S);
+    }
+  }
+  
+  //each search gets its own buffer, and they are concatenated in order, 
+  //so the polygons don't depend on the number of threads
+  int num_searches = (int)searches.size();
+  std::vector<std::vector<Poly> > by_search(num_searches);
+  if (num_threads > num_searches) {
+    num_threads = num_searches;
+  }
+  if (num_threads <= 1) {
+    for (i=0; i<num_searches; i++) {
+      polys_starting_with(C, RL, searches[i].first_rect, 
+                          (int)G->verts[searches[i].vertex].incident_edges.size(), 
+                          searches[i].max_rects, require_folded, ffolded, pricer, 
+                          verbose, by_search[i]);
     }
-  }    
+  } else {
+    std::atomic<int> next_search(0);
+    std::vector<std::thread> threads(0);
+    for (t=0; t<num_threads; t++) {
+      threads.push_back(std::thread(polys_worker<T>, &C, &RL, &searches, 
+                                    require_folded, ffolded, pricer, verbose, 
+                                    &next_search, &by_search));
+    }
+    for (t=0; t<num_threads; t++) {
+      threads[t].join();
+    }
+  }
+  
+  int num_polys = 0;
+  for (i=0; i<num_searches; i++) {
+    num_polys += by_search[i].size();
+  }
+  if (pricer != NULL && num_polys > pricer->max_found) {
+    num_polys = pricer->max_found;
+  }
+  P.reserve(P.size() + num_polys);
+  for (i=0; i<num_searches && num_polys > 0; i++) {
+    if ((int)by_search[i].size() > num_polys) {
+      by_search[i].resize(num_polys);
+    }
+    num_polys -= by_search[i].size();
+    P.insert(P.end(), std::make_move_iterator(by_search[i].begin()), 
+                      std::make_move_iterator(by_search[i].end()));
+  }
 }
 
 namespace GALLOP {
@@ -322,7 +459,9 @@ std::ostream& operator<<(std::ostream& os, Poly P) {
 
 RectList::RectList() {
   r.resize(0);
-  rects_starting_with.resize(0);
+  rects_start.assign(1, 0);
+  rects_from.resize(0);
+  num_letters = 0;
 }
 
 RectList::RectList(Chain& C,
@@ -333,7 +472,7 @@ RectList::RectList(Chain& C,
   Rect temp_rect;
   int temp_vert;
   r.resize(0);
-  rects_starting_with.resize((int)C.CL.size());
+  std::vector<std::vector<int> > rects_starting_with((int)C.CL.size());
   int i,j,k,m;
   for (i=0; i<(int)C.CL.size(); i++) {
     rects_starting_with[i].resize(0);
@@ -418,20 +557,31 @@ RectList::RectList(Chain& C,
       }
     }
   }  
+  
+  //flatten the lists, keeping their order, and index the pairs
+  num_letters = C.CL.size();
+  rects_start.resize(num_letters+1);
+  rects_from.resize(0);
+  rects_from.reserve(2*r.size());
+  rect_from_pair.clear();
+  rect_from_pair.reserve(2*r.size());
+  for (i=0; i<num_letters; i++) {
+    rects_start[i] = rects_from.size();
+    for (j=0; j<(int)rects_starting_with[i].size(); j++) {
+      rects_from.push_back(rects_starting_with[i][j]);
+    }
+  }
+  rects_start[num_letters] = rects_from.size();
+  for (i=0; i<(int)r.size(); i++) {
+    rect_from_pair[(long long)r[i].first*num_letters + r[i].second] = i+1;
+    rect_from_pair[(long long)r[i].second*num_letters + r[i].first] = -(i+1);
+  }
 }
 
 
 int RectList::find_index_from_pair(int a, int b) {
-  int i,ind,sign;
-  for (i=0; i<(int)rects_starting_with[a].size(); i++) {
-    extract_signed_index(rects_starting_with[a][i], &ind, &sign);
-    if (sign == 1 && r[ind].second == b) {
-      return sign*ind;
-    } else if (sign == -1 && r[ind].first == b) {
-      return sign*ind;
-    }
-  }
-  return 0; 
+  std::unordered_map<long long, int>::iterator it = rect_from_pair.find((long long)a*num_letters + b);
+  return (it == rect_from_pair.end() ? 0 : it->second);
 }
 
 namespace GALLOP {
@@ -442,15 +592,18 @@ std::ostream& operator<<(std::ostream& os, Rect R) {
 }
 }
 
+//cyclically reduce a word which may begin with a '.' marking its 
+//first letter; the mark stays at the front
 void cyc_red_marked(std::string& s) {
-  while ( (s.size() > 0) && (s[0] == swapCaseChar(s[s.size()-1])) ) {
-    s.erase(0,1);
-    s.erase(s.size()-1, 1);
-  }
-  if (s[0] == '.') {
-    while ( (s.size() > 0) && (s[1] == swapCaseChar(s[s.size()-1])) ) {
-      s.erase(1,1);
-      s.erase(s.size()-1, 1);
+  cyc_red(s);
+  if (s.size() > 0 && s[0] == '.') {
+    int sl = s.size();
+    int k = 0;
+    while (1+k < sl-1-k && s[1+k] == swapCaseChar(s[sl-1-k])) {
+      k++;
+    }
+    if (k > 0) {
+      s = "." + s.substr(1+k, sl-1-2*k);
     }
   }
 }
@@ -742,6 +895,8 @@ void gallop_lp(Chain& C,
                std::vector<Poly>& P, 
                std::vector<Rational>& solution_vector, 
                Rational& scl, 
+               std::vector<Rational>* dual_vector,
+               std::vector<double>* double_dual_vector,
                bool only_check_exists,
                bool check_polygonal,
                SparseLPSolver solver,
@@ -761,10 +916,12 @@ void gallop_lp(Chain& C,
   std::vector<int> temp_ja(0);
   std::vector<int> temp_ar(0);
   
+  STATS::phase("lp_setup");
   SparseLP LP(solver, num_rows, num_cols);
   
-  //run through the columns
+  //run through the columns (in order, so the LP can store them compressed)
   for (i=0; i<num_cols; i++) {
+    LP.begin_column(i);
     temp_ia.resize(0); temp_ja.resize(0); temp_ar.resize(0);
     LP.set_obj(i, (int)(only_check_exists ? 0 : P[i].rects.size()-2));
     //objective[i] = (only_check_exists ? 0 : ((double)P[i].rects.size())-2);
@@ -797,13 +954,189 @@ void gallop_lp(Chain& C,
     //RHS[RL.r.size() + i] = C.weights[i];
   }
   
+  STATS::phase("solve");
   SparseLPSolveCode code = LP.solve(verbose);
   
+  STATS::phase("recovery");
+  if (dual_vector != NULL) dual_vector->resize(0);
+  if (double_dual_vector != NULL) double_dual_vector->resize(0);
   if (code != LP_OPTIMAL) {
     scl = Rational(-1,1);
   } else {
     LP.get_optimal_value(scl);
     LP.get_soln_vector(solution_vector);
+    if (dual_vector != NULL) LP.get_dual_vector(*dual_vector);
+    if (double_dual_vector != NULL) LP.get_dual_vector(*double_dual_vector);
+  }
+}
+
+
+/*****************************************************************************
+ * column generation (-P).  We start with the polygons with few sides (as 
+ * few as gives a feasible LP), and then repeatedly search for polygons 
+ * with negative reduced cost under the duals of the current LP, until 
+ * there are none, so the answer is the same as with all the polygons.  
+ * The reduced cost of a polygon is a sum over its rectangles, less 2, so 
+ * the search is the usual one, cut off when even the lightest way of 
+ * finishing the polygon can't bring its weight under 2.
+ * ***************************************************************************/
+//the weight of a rectangle is its share of the reduced cost: 1 for the 
+//objective, less the duals of the rows its column has entries in
+template <typename T>
+static void set_up_pricer(Chain& C, 
+                          RectList& RL, 
+                          bool check_polygonal, 
+                          int max_rects,
+                          std::vector<T>& duals,
+                          std::set<std::vector<int> >& existing,
+                          PolyPricer<T>& pricer) {
+  int i,k,si,L;
+  int ind, sign;
+  int letter, next;
+  int num_letters = C.CL.size();
+  pricer.num_rects = RL.r.size();
+  pricer.weight.assign(2*pricer.num_rects+1, T(0));
+  for (si=-pricer.num_rects; si<=pricer.num_rects; si++) {
+    if (si == 0) continue;
+    extract_signed_index(si, &ind, &sign);
+    pricer.w(si) = T(1) - duals[ind]*T(sign);
+    letter = (sign < 0 ? RL.r[ind].second : RL.r[ind].first);
+    if (C.CL[letter].position.second == 0 && 
+        (!check_polygonal || C.CL[letter].position.first == 0)) {
+      pricer.w(si) = pricer.w(si) - duals[RL.r.size() + C.CL[letter].position.first];
+    }
+  }
+  
+  //bound[k][L] is the least weight of a rectangle starting at L, plus 
+  //bound[k-1] at the letter after it (if that's negative)
+  pricer.bound.assign(max_rects+1, std::vector<T>(num_letters, T(0)));
+  pricer.has_bound.assign(max_rects+1, std::vector<bool>(num_letters, false));
+  for (k=1; k<=max_rects; k++) {
+    for (L=0; L<num_letters; L++) {
+      for (i=0; i<RL.num_starting_with(L); i++) {
+        si = RL.starting_with(L)[i];
+        extract_signed_index(si, &ind, &sign);
+        next = C.next_letter(sign < 0 ? RL.r[ind].first : RL.r[ind].second);
+        T b = pricer.w(si);
+        if (pricer.has_bound[k-1][next] && is_negative(pricer.bound[k-1][next])) {
+          b = b + pricer.bound[k-1][next];
+        }
+        if (!pricer.has_bound[k][L] || b < pricer.bound[k][L]) {
+          pricer.bound[k][L] = b;
+          pricer.has_bound[k][L] = true;
+        }
+      }
+    }
+  }
+  pricer.threshold = T(2);
+  pricer.existing = &existing;
+  pricer.max_found = GALLOP_MAX_PRICED_POLYS;
+}
+
+static void gallop_lp_column_generation(Chain& C,
+                                        RectList& RL, 
+                                        std::vector<Poly>& P, 
+                                        std::vector<Rational>& solution_vector, 
+                                        Rational& scl, 
+                                        bool only_check_exists,
+                                        bool check_polygonal,
+                                        bool require_folded,
+                                        int require_f_folded,
+                                        int max_polygon_valence,
+                                        int num_threads,
+                                        SparseLPSolver solver,
+                                        int time_limit,
+                                        int verbose) {
+  int i;
+  int max_rects = 0;
+  for (i=0; i<C.G->num_verts; i++) {
+    if ((int)C.G->verts[i].incident_edges.size() > max_rects) {
+      max_rects = C.G->verts[i].incident_edges.size();
+    }
+  }
+  if (max_polygon_valence > 0) {
+    max_rects = max_polygon_valence;
+  }
+  
+  //the smallest polygons which give a feasible LP
+  int start_sides = (max_rects < GALLOP_START_SIDES ? max_rects : GALLOP_START_SIDES);
+  while (true) {
+    STATS::phase("polygons");
+    compute_polys(P, RL, C, require_folded, require_f_folded, start_sides, 
+                  num_threads, (PolyPricer<double>*)NULL, verbose);
+    if ((int)P.size() > 0) {
+      gallop_lp(C, RL, P, solution_vector, scl, NULL, NULL, only_check_exists, 
+                check_polygonal, solver, time_limit, verbose);
+    }
+    if (verbose > 1) {
+      std::cout << "Starting with " << P.size() << " polygons of at most " 
+                << start_sides << " sides: " 
+                << (scl < Rational(0,1) || (int)P.size() == 0 ? "infeasible" : "feasible") << "\n";
+    }
+    if (((int)P.size() > 0 && !(scl < Rational(0,1))) || start_sides >= max_rects) {
+      break;
+    }
+    start_sides++;
+  }
+  if ((int)P.size() == 0) {
+    scl = Rational(-1,1);
+    return;
+  }
+  //if all that's wanted is a feasible surface, we've got it
+  if (scl < Rational(0,1) || only_check_exists || start_sides >= max_rects) {
+    return;
+  }
+  
+  bool exact = gives_exact_duals(solver);
+  std::set<std::vector<int> > existing;
+  for (i=0; i<(int)P.size(); i++) {
+    existing.insert(P[i].rects);
+  }
+  std::vector<Rational> duals(0);
+  std::vector<double> double_duals(0);
+  for (int round=0; ; ++round) {
+    gallop_lp(C, RL, P, solution_vector, scl, 
+              (exact ? &duals : NULL), (exact ? NULL : &double_duals), 
+              only_check_exists, check_polygonal, solver, time_limit, verbose);
+    if (scl < Rational(0,1)) {
+      break;
+    }
+    if ((int)duals.size() == 0 && (int)double_duals.size() == 0) {
+      //without duals there's no pricing, so we use all the polygons
+      if (verbose > 1) {
+        std::cout << "The solver gave no duals, so using all the polygons\n";
+      }
+      STATS::phase("polygons");
+      compute_polys(P, RL, C, require_folded, require_f_folded, max_rects, 
+                    num_threads, (PolyPricer<double>*)NULL, verbose);
+      gallop_lp(C, RL, P, solution_vector, scl, NULL, NULL, only_check_exists, 
+                check_polygonal, solver, time_limit, verbose);
+      break;
+    }
+    STATS::phase("pricing");
+    int old_size = P.size();
+    if (exact) {
+      PolyPricer<Rational> pricer;
+      set_up_pricer(C, RL, check_polygonal, max_rects, duals, existing, pricer);
+      compute_polys(P, RL, C, require_folded, require_f_folded, max_rects, 
+                    num_threads, &pricer, verbose);
+    } else {
+      PolyPricer<double> pricer;
+      set_up_pricer(C, RL, check_polygonal, max_rects, double_duals, existing, pricer);
+      compute_polys(P, RL, C, require_folded, require_f_folded, max_rects, 
+                    num_threads, &pricer, verbose);
+    }
+    for (i=old_size; i<(int)P.size(); i++) {
+      existing.insert(P[i].rects);
+    }
+    if (verbose > 1) {
+      std::cout << "Column generation round " << round << ": " 
+                << "scl <= " << scl << "; added " << (int)P.size() - old_size
+                << " polygons (now " << P.size() << ")\n";
+    }
+    if ((int)P.size() == old_size) {
+      break;
+    }
   }
 }
 
@@ -829,9 +1162,11 @@ void GALLOP::gallop(int argc, char** argv) {
   bool check_polygonal_relaxed = false;
   SparseLPSolver solver = GLPK_SIMPLEX;
   int time_limit=0;
+  int num_threads = 1;
+  bool column_generation = false;
   
   if (argc < 1 || std::string(argv[0]) == "-h") {
-    std::cout << "usage: ./scallop -local [-v[n]] [-f] [-ff[n=1]] [-e] [-tn] [-pn] [-y,Y] [-m<GLPK,GIPT,GUROBI,EXLP>] [-G<graph input file>] [-o <surface (graph) output file>] <chain>\n";
+    std::cout << "usage: ./scallop -local [-v[n]] [-f] [-ff[n=1]] [-e] [-P] [-tn] [-j[n]] [-pn] [-y,Y] [-m<GLPK,GIPT,GUROBI,EXLP,HYBRID>] [-G<graph input file>] [-o <surface (graph) output file>] <chain>\n";
     std::cout << "\t-v[n]: verbose output (level n)\n";
     std::cout << "\t-y: check if the chain is polygonal (overrides -f,-ff,-p)\n";
     std::cout << "\t-Y: check polygonal without folded restriction\n";
@@ -840,7 +1175,10 @@ void GALLOP::gallop(int argc, char** argv) {
     std::cout << "\t\tn is the number of words in delta^- (these must come first)\n";
     std::cout << "\t\tmark verts in delta^+ with periods\n";
     std::cout << "\t-e: only check the existence of a feasible surface\n";
+    std::cout << "\t-P: start with small polygons and add the others by column generation\n";
+    std::cout << "\t    (same answer, without listing every polygon)\n";
     std::cout << "\t-tn: set an LP time limit of n seconds (only works with Gurobi)\n";
+    std::cout << "\t-j[n]: enumerate the polygons with n threads (all cores if n is omitted)\n";
     std::cout << "\t-pn: only use polygons which have at most n sides\n";
     std::cout << "\t-m<method>: specify which LP solver to use\n";
     std::cout << "\t-o filename: write out the solution fatgraph\n";
@@ -872,6 +1210,10 @@ void GALLOP::gallop(int argc, char** argv) {
       only_check_exists = true;
     }
     
+    else if (argv[current_arg][1] == 'P') {
+      column_generation = true;
+    }
+    
     else if (argv[current_arg][1] == 'o') {
       do_output = true;
       current_arg++;
@@ -882,9 +1224,19 @@ void GALLOP::gallop(int argc, char** argv) {
       time_limit = atoi(&argv[current_arg][2]);
     }
     
+    else if (argv[current_arg][1] == 'j') {
+      if (argv[current_arg][2] == '\0') {
+        num_threads = (int)std::thread::hardware_concurrency();
+      } else {
+        num_threads = atoi(&argv[current_arg][2]);
+      }
+    }
+    
     else if (argv[current_arg][1] == 'm') {
       if (argv[current_arg][2] == 'E') {
         solver = EXLP;
+      } else if (argv[current_arg][2] == 'H') {
+        solver = GLPK_EXACT;
       } else {
         if (argv[current_arg][3] == 'L') {
           solver = GLPK;
@@ -978,6 +1330,7 @@ void GALLOP::gallop(int argc, char** argv) {
   
   
   //compute the polygons and rectangles
+  STATS::phase("rectangles");
   RL = RectList(C, require_f_folded, check_polygonal, verbose);
   if (verbose > 1) {
     std::cout << "Generated " << RL.r.size() << " rectangles\n";
@@ -989,41 +1342,61 @@ void GALLOP::gallop(int argc, char** argv) {
   }
   
   std::vector<Poly> P(0);
-  compute_polys(P, RL, C, require_folded, require_f_folded, max_polygon_valence, verbose);
-   if (verbose > 1) {
-    std::cout << "Generated " << P.size() << " polygons\n";
-    if (verbose > 2) {
-      for (i=0; i<(int)P.size(); i++) {
-        std::cout << i << ": ";
-        for (j=0; j<(int)P[i].rects.size(); j++) {
-          std::cout << P[i].rects[j] << " ";
-        }
-        std::cout << "\n";
+  std::vector<Rational> solution_vector(0);
+  Rational scl;
+  if (column_generation) {
+    gallop_lp_column_generation(C, RL, P, solution_vector, scl, 
+                                only_check_exists, check_polygonal, 
+                                require_folded, require_f_folded, max_polygon_valence, 
+                                num_threads, solver, time_limit, verbose);
+    if (verbose > 1) {
+      std::cout << "Used " << P.size() << " polygons\n";
+    }
+    if ((int)P.size() == 0) {
+      if (verbose > 0) {
+        std::cout << "No feasible solution found\n";
       }
+      return;
     }
-  } 
+  } else {
+    STATS::phase("polygons");
+    compute_polys(P, RL, C, require_folded, require_f_folded, max_polygon_valence, 
+                  num_threads, (PolyPricer<double>*)NULL, verbose);
+    if (verbose > 1) {
+      std::cout << "Generated " << P.size() << " polygons\n";
+      if (verbose > 2) {
+        for (i=0; i<(int)P.size(); i++) {
+          std::cout << i << ": ";
+          for (j=0; j<(int)P[i].rects.size(); j++) {
+            std::cout << P[i].rects[j] << " ";
+          }
+          std::cout << "\n";
+        }
+      }
+    } 
   
-  if (P.size() == 0) {
-    if (verbose > 0) {
-      std::cout << "No feasible solution found\n";
+    if (P.size() == 0) {
+      if (verbose > 0) {
+        std::cout << "No feasible solution found\n";
+      }
+      return;
     }
-    return;
-  }
   
-  //do the linear programming
-  std::vector<Rational> solution_vector(0);
-  Rational scl;
-  gallop_lp(C, 
-            RL, 
-            P, 
-            solution_vector, 
-            scl, 
-            only_check_exists, 
-            check_polygonal,
-            solver,
-            time_limit,
-            verbose);
+    //do the linear programming
+    gallop_lp(C, 
+              RL, 
+              P, 
+              solution_vector, 
+              scl, 
+              NULL, NULL,
+              only_check_exists, 
+              check_polygonal,
+              solver,
+              time_limit,
+              verbose);
+  }
   
+  STATS::phase("output");
   if (verbose > 0) {
     if (scl < Rational(0,1)) {
       std::cout << "No feasible solution found\n";
@@ -5,9 +5,15 @@
 #include <vector>
 #include <string>
 #include <iostream>
+#include <unordered_map>
 #include "../rational.h"
 #include "graph.h"
 
+//for column generation (-P): how many sides the first polygons may 
+//have, and how many polygons one search may add at a time
+#define GALLOP_START_SIDES 3
+#define GALLOP_MAX_PRICED_POLYS 2000
+
 namespace GALLOP {
 
 struct ChainLetter {
@@ -57,11 +63,18 @@ struct Rect {
 
 struct RectList {
   std::vector<Rect> r;
-  std::vector<std::vector<int> > rects_starting_with;
+  //the signed indices of the rectangles starting with letter a are 
+  //rects_from[rects_start[a]] up to (not including) rects_from[rects_start[a+1]]
+  std::vector<int> rects_start;
+  std::vector<int> rects_from;
+  std::unordered_map<long long, int> rect_from_pair;  //a*num_letters+b -> signed index
+  int num_letters;
   
   RectList(Chain& C, int require_f_folded, bool check_no_inverse_pairings, int verbose);
   RectList();
-  int find_index_from_pair(int a, int b);
+  int find_index_from_pair(int a, int b);  //the signed index, or 0 if there isn't one
+  int num_starting_with(int a) { return rects_start[a+1] - rects_start[a]; }
+  const int* starting_with(int a) { return rects_from.data() + rects_start[a]; }
 };
 
 
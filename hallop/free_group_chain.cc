@@ -47,6 +47,8 @@ HALLOP::FreeGroupChain::FreeGroupChain(char** input, int num_strings) {
     }
     weight = std::string(input[i]).substr(0,j);
     word = std::string(&input[i][j]);
+    red(word);
+    cyc_red(word);
     if (weight == "") {
       temp_weights.push_back(1);
     } else {
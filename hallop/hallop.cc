@@ -4,6 +4,7 @@
 
 #include "../lp.h"
 #include "../rational.h"
+#include "../stats.h"
 
 #include "free_group_chain.h"
 #include "pieces.h"
@@ -17,10 +18,10 @@ void HALLOP::hallop(int argc, char** argv) {
   bool lp_verbose = false;
   
   if (argc < 1 || std::string(argv[0]) == "-h") {
-    std::cout << "usage: ./scallop -hyp [-m<GLPK,GIPT,EXLP,GUROBI>] [-v[n]] [-R<relator>] <chain>\n";
+    std::cout << "usage: ./scallop -hyp [-m<GLPK,GIPT,EXLP,HYBRID,GUROBI>] [-v[n]] [-R<relator>] <chain>\n";
     std::cout << "\twhere <chain> allows integral weights on the words\n";
     std::cout << "\t-h: print this message\n";
-    std::cout << "\t-m: use the LP solver specified (EXLP uses exact arithmetic)\n";
+    std::cout << "\t-m: use the LP solver specified (EXLP uses exact arithmetic, HYBRID uses GLPK and checks the answer exactly)\n";
     std::cout << "\t-v[n]: verbosity (if -v isn't used, n=1, if -v but no n, then n=2)\n";
     std::cout << "\t-R relator: add a relator\n";
     std::cout << "\tExample: ./scallop -hyp -RabABcdCD abAB\n";
@@ -42,6 +43,8 @@ void HALLOP::hallop(int argc, char** argv) {
           solver = GLPK_IPT; break;
         case 'X':
           solver = EXLP; break;
+        case 'Y':
+          solver = GLPK_EXACT; break;
         case 'U':
           solver = GUROBI; break;
       }
@@ -79,6 +82,7 @@ void HALLOP::hallop(int argc, char** argv) {
     std::cout << "Chain with relators: " << CR << "\n";
   }
   
+  STATS::phase("pieces");
   Pieces P(CR);
   
   if (verbose > 2) {
@@ -91,6 +95,8 @@ void HALLOP::hallop(int argc, char** argv) {
   
   hallop_lp(CR, P, solver, scl, soln_vec, lp_verbose);
   
+  STATS::phase("output");
+  
   if (verbose > 0) {
     std::cout << "Lower bound on scl: " << scl << "\n";
   }
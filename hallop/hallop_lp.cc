@@ -1,6 +1,8 @@
 #include <vector>
 #include <iostream>
 
+#include "../stats.h"
+
 #include "hallop_lp.h"
 
 
@@ -41,13 +43,17 @@ void HALLOP::hallop_lp(HALLOP::FreeGroupChain& C,
   int NR = words_start_row + C.num_words();
   int NC = relators_start_column + num_relators;
   
+  STATS::phase("lp_setup");
   SparseLP LP(solver, NR, NC);
   
   /*********** matrix entries ******************/
   
+  //the columns are filled in order, so the LP can store them compressed
+  
   //add the entries for all the rectangles
   for (int i=0; i<Nrects; ++i) {
     int ind, s;
+    LP.begin_column(i);
     
     //these are the gluing edge conditions
     extract_signed_index(P.rects[i].b1, ind, s);
@@ -67,6 +73,7 @@ void HALLOP::hallop_lp(HALLOP::FreeGroupChain& C,
   //add entries for the triangles
   for (int i=0; i<Ntris; ++i) {
     int ind, s;
+    LP.begin_column(Nrects + i);
     //these are the gluing edge conditions
     extract_signed_index(P.tris[i].b1, ind, s);
     LP.add_entry(ind, Nrects + i, s);
@@ -78,6 +85,7 @@ void HALLOP::hallop_lp(HALLOP::FreeGroupChain& C,
   
   //add the entries for the relator columns
   for (int i=0; i<num_relators; ++i) {
+    LP.begin_column(relators_start_column + i);
     LP.add_entry(words_start_row + relators_start_word + i, relators_start_column + i, -1);
   }
   
@@ -113,7 +121,9 @@ void HALLOP::hallop_lp(HALLOP::FreeGroupChain& C,
 
   /************** solving ***********************/
 
+  STATS::phase("solve");
   LP.solve(verbose-1);
+  STATS::phase("recovery");
 
   LP.get_optimal_value(scl);
   LP.get_soln_vector(soln_vec);
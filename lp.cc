@@ -1,9 +1,14 @@
 #include <vector>
 #include <string>
 #include <iostream>
+#include <map>
+#include <set>
+#include <algorithm>
 
 #include <glpk.h>
 
+#include "stats.h"
+
 #ifdef GUROBI_INSTALLED
 extern "C" {
 #include <gurobi_c.h>
@@ -23,6 +28,80 @@ extern "C" {
 #include "exlp-package/mylib.h"
 }
 
+//the solvers which keep the problem as integers and give a rational answer
+static bool exact_storage(SparseLPSolver s) {
+  return (s == EXLP || s == GLPK_EXACT);
+}
+
+bool gives_exact_duals(SparseLPSolver s) {
+  return (s == GLPK_EXACT);
+}
+
+bool is_negative(double d) {
+  return d < -1e-9;
+}
+
+bool is_negative(const Rational& d) {
+  return d < 0;
+}
+
+SparseLPBackend::SparseLPBackend() {
+  solver = GLPK;
+  prob = NULL;
+  env = NULL;
+  num_loaded_entries = 0;
+  stale_ia.resize(0);
+  stale_ja.resize(0);
+  dirty_rows.resize(0);
+  dirty_cols.resize(0);
+}
+
+SparseLPBackend::SparseLPBackend(const SparseLPBackend& other) {
+  solver = other.solver;
+  prob = NULL;
+  env = NULL;
+  num_loaded_entries = 0;
+}
+
+SparseLPBackend& SparseLPBackend::operator=(const SparseLPBackend& other) {
+  if (this != &other) {
+    clear();
+    solver = other.solver;
+  }
+  return *this;
+}
+
+SparseLPBackend::~SparseLPBackend() {
+  clear();
+}
+
+void SparseLPBackend::clear() {
+  if (prob != NULL) {
+    if (solver == GLPK || solver == GLPK_SIMPLEX || solver == GLPK_IPT) {
+      glp_delete_prob((glp_prob*)prob);
+    }
+#ifdef GUROBI_INSTALLED
+    if (solver == GUROBI || solver == GUROBI_SIMPLEX || solver == GUROBI_IPT) {
+      GRBfreemodel((GRBmodel*)prob);
+      GRBfreeenv((GRBenv*)env);
+    }
+#endif
+  }
+  prob = NULL;
+  env = NULL;
+  num_loaded_entries = 0;
+  stale_ia.resize(0);
+  stale_ja.resize(0);
+  dirty_rows.resize(0);
+  dirty_cols.resize(0);
+}
+
+bool SparseLPBackend::is_loaded(SparseLPSolver s) {
+  return (prob != NULL && solver == s);
+}
+
+
+
 SparseLP::SparseLP(SparseLPSolver s) {
   ia.resize(0);
   ja.resize(0);
@@ -35,6 +114,8 @@ SparseLP::SparseLP(SparseLPSolver s) {
   eq_type.resize(0);
   soln_vector.resize(0);
   double_soln_vector.resize(0);
+  dual_vector.resize(0);
+  double_dual_vector.resize(0);
   num_rows = 0;
   num_cols = 0;
   solver = s;
@@ -45,6 +126,9 @@ SparseLP::SparseLP(SparseLPSolver s) {
   col_bounds.resize(0);
   col_bounds_double.resize(0);
   col_bound_types.resize(0);
+  by_columns = false;
+  col_start.resize(0);
+  row_index.resize(0);
 }
 
 SparseLP::SparseLP(SparseLPSolver s, int nr, int nc) {
@@ -52,7 +136,7 @@ SparseLP::SparseLP(SparseLPSolver s, int nr, int nc) {
   ja.resize(0);
   ar.resize(0);
   double_ar.resize(0);
-  if (s == EXLP) {
+  if (exact_storage(s)) {
     objective.resize(nc);
     double_objective.resize(0);
     RHS.resize(nr);
@@ -67,6 +151,8 @@ SparseLP::SparseLP(SparseLPSolver s, int nr, int nc) {
     soln_vector.resize(0);
     double_soln_vector.resize(nc);
   }
+  dual_vector.resize(0);
+  double_dual_vector.resize(0);
   eq_type.resize(nr);
   num_rows = nr;
   num_cols = nc;
@@ -78,6 +164,9 @@ SparseLP::SparseLP(SparseLPSolver s, int nr, int nc) {
   col_bounds.resize(0);
   col_bounds_double.resize(0);
   col_bound_types.resize(0);
+  by_columns = false;
+  col_start.resize(0);
+  row_index.resize(0);
   //std::cout << "Made new LP problem with solver: " << solver << "\n";
 }
 
@@ -85,7 +174,7 @@ void SparseLP::write_to_file(std::string filename) {
 }
 
 void SparseLP::set_num_rows(int nr) {
-  if (solver == EXLP) {
+  if (exact_storage(solver)) {
     RHS.resize(nr);
     double_RHS.resize(0);
   } else {
@@ -94,10 +183,11 @@ void SparseLP::set_num_rows(int nr) {
   }
   eq_type.resize(nr);
   num_rows = nr;
+  backend.clear();
 }
 
 void SparseLP::set_num_cols(int nc) {
-  if (solver == EXLP) {
+  if (exact_storage(solver)) {
     objective.resize(nc);
     double_objective.resize(0);
     soln_vector.resize(nc);
@@ -109,12 +199,14 @@ void SparseLP::set_num_cols(int nc) {
     double_soln_vector.resize(nc);
   }
   num_cols = nc;
+  backend.clear();
 }
 
 void SparseLP::set_col_type(int c, SparseLPColumnType t) {
   if (t == REAL && num_ints == 0) {
     return; //no need to do anything
   }
+  if (backend.prob != NULL) backend.dirty_cols.push_back(c);
   if (t == REAL) {
     if (num_ints == 1) {
       num_ints = 0;
@@ -140,27 +232,29 @@ void SparseLP::set_col_bound(int c, SparseLPColumnBoundType t) {
   if ((int)col_bounds.size() == 0) {
     if (t == LB) return;
     col_bound_types.resize(num_cols, LB);
-    if (solver == EXLP) {
+    if (exact_storage(solver)) {
       col_bounds.resize(num_cols, 0);
     } else {
       col_bounds_double.resize(num_cols, 0);
     }
   }
   col_bound_types[c] = t;
+  if (backend.prob != NULL) backend.dirty_cols.push_back(c);
 }
 
 void SparseLP::set_col_bound(int c, SparseLPColumnBoundType t, double b) {
   if ((int)col_bounds.size() == 0) {
     if (t == LB) return;
     col_bound_types.resize(num_cols, LB);
-    if (solver == EXLP) {
+    if (exact_storage(solver)) {
       col_bounds.resize(num_cols, 0);
     } else {
       col_bounds_double.resize(num_cols, 0);
     }
   }
   col_bound_types[c] = t;
-  if (solver == EXLP) {
+  if (backend.prob != NULL) backend.dirty_cols.push_back(c);
+  if (exact_storage(solver)) {
     std::cout << "Can't input a double column bound for rational LP\n";
   } else {
     col_bounds_double[c] = b;
@@ -171,14 +265,15 @@ void SparseLP::set_col_bound(int c, SparseLPColumnBoundType t, int b) {
   if ((int)col_bounds.size() == 0) {
     if (t == LB) return;
     col_bound_types.resize(num_cols, LB);
-    if (solver == EXLP) {
+    if (exact_storage(solver)) {
       col_bounds.resize(num_cols, 0);
     } else {
       col_bounds_double.resize(num_cols, 0);
     }
   }
   col_bound_types[c] = t;
-  if (solver == EXLP) {
+  if (backend.prob != NULL) backend.dirty_cols.push_back(c);
+  if (exact_storage(solver)) {
     col_bounds[c] = b;
   } else {
     col_bounds_double[c] = (double)b;
@@ -187,41 +282,119 @@ void SparseLP::set_col_bound(int c, SparseLPColumnBoundType t, int b) {
 
   
 
+//sort the entries from start on by row, summing duplicates and dropping 
+//the ones which come to zero; returns the new number of entries
+template <typename T>
+static int merge_column(std::vector<int>& rows, std::vector<T>& vals, int start) {
+  std::vector<std::pair<int, T> > col(0);
+  for (int k=start; k<(int)rows.size(); ++k) {
+    col.push_back(std::make_pair(rows[k], vals[k]));
+  }
+  std::sort(col.begin(), col.end());
+  int nnz = start;
+  for (int k=0; k<(int)col.size(); ++k) {
+    if (nnz > start && rows[nnz-1] == col[k].first) {
+      vals[nnz-1] += col[k].second;
+      continue;
+    }
+    if (nnz > start && vals[nnz-1] == 0) {
+      nnz--;
+    }
+    rows[nnz] = col[k].first;
+    vals[nnz] = col[k].second;
+    nnz++;
+  }
+  if (nnz > start && vals[nnz-1] == 0) {
+    nnz--;
+  }
+  rows.resize(nnz);
+  vals.resize(nnz);
+  return nnz;
+}
+
+//close off the current (last) column, and start empty ones until 
+//column j is the current one
+void SparseLP::advance_column(int j) {
+  int c = (int)col_start.size()-1;
+  if (c >= j) {
+    return;
+  }
+  int nnz;
+  if (exact_storage(solver)) {
+    nnz = merge_column(row_index, ar, col_start[c]);
+  } else {
+    nnz = merge_column(row_index, double_ar, col_start[c]);
+  }
+  while ((int)col_start.size() <= j) {
+    col_start.push_back(nnz);
+  }
+}
+
+//switch to compressed column storage (if we haven't already), and start 
+//column j; all its entries must be added before those of any later column
+void SparseLP::begin_column(int j) {
+  if (!by_columns) {
+    if ((int)ia.size() > 0) {
+      std::cout << "Can't switch to column storage after adding entries\n";
+      return;
+    }
+    by_columns = true;
+    col_start.assign(1, 0);
+    row_index.resize(0);
+  }
+  if (j < (int)col_start.size()-1) {
+    std::cout << "Columns must be given in order\n";
+    return;
+  }
+  advance_column(j);
+}
+
+//record where a new entry goes, in whichever storage we're using
+bool SparseLP::push_index(int i, int j) {
+  if (!by_columns) {
+    ia.push_back(i);
+    ja.push_back(j);
+    return true;
+  }
+  if (j < (int)col_start.size()-1) {
+    std::cout << "Entries must be added a column at a time\n";
+    return false;
+  }
+  advance_column(j);
+  row_index.push_back(i);
+  return true;
+}
+
 void SparseLP::add_entry(int i, int j, Rational& r) {
-  if (solver == EXLP) {
+  if (exact_storage(solver)) {
     if (r.d() != 1) {
       std::cout << "You can give a rational entry, but it needs to be an integer\n";
       return;
     }
-    ia.push_back(i);
-    ja.push_back(j);
+    if (!push_index(i, j)) return;
     ar.push_back(r.n());
   } else {
-    ia.push_back(i);
-    ja.push_back(j);
+    if (!push_index(i, j)) return;
     double_ar.push_back(r.get_d());
   }
 }
   
 
 void SparseLP::add_entry(int i, int j, int a) {
-  if (solver == EXLP) {
-    ia.push_back(i);
-    ja.push_back(j);
+  if (exact_storage(solver)) {
+    if (!push_index(i, j)) return;
     ar.push_back(a);
   } else {
-    ia.push_back(i);
-    ja.push_back(j);
+    if (!push_index(i, j)) return;
     double_ar.push_back((double)a);
   }
 }
     
 void SparseLP::add_entry(int i, int j, double a) {
-  if (solver == EXLP) {
+  if (exact_storage(solver)) {
     std::cout << "Can't input a double for rational LP\n";
   } else {
-    ia.push_back(i);
-    ja.push_back(j);
+    if (!push_index(i, j)) return;
     double_ar.push_back(a);
   }
 }
@@ -230,33 +403,27 @@ void SparseLP::add_entry(int i, int j, double a) {
 void SparseLP::extend_entries_no_dups(std::vector<int> &temp_ia,
                                        std::vector<int> &temp_ja,
                                        std::vector<int> &temp_ar) {
-  int j, k, temp;
-  for (j=0; j<(int)temp_ia.size(); j++) {
-    if (temp_ar[j] == 0) {
-      continue;
-    }
-    temp = 0;
-    for (k=0; k<(int)temp_ia.size(); k++) {
-      if (temp_ia[k] == temp_ia[j]) {
-        temp += temp_ar[k];
-        temp_ar[k] = 0;
-      }
-    }
-    add_entry(temp_ia[j], temp_ja[j], temp);
-    //ja.push_back(temp_ja[j]);
-    //ia.push_back(temp_ia[j]);
-    //ar.push_back(temp);
+  accumulator.merge(temp_ia, temp_ar);
+  for (int k=0; k<(int)accumulator.first.size(); k++) {
+    int j = accumulator.first[k];
+    add_entry(temp_ia[j], temp_ja[j], accumulator.sum[k]);
   }
 }
 
 void SparseLP::extend_entries_no_dups(std::vector<int>& temp_ia, 
                                       std::vector<int>& temp_ja,
                                       std::vector<double>& temp_ar) {
+  double_accumulator.merge(temp_ia, temp_ar);
+  for (int k=0; k<(int)double_accumulator.first.size(); k++) {
+    int j = double_accumulator.first[k];
+    add_entry(temp_ia[j], temp_ja[j], double_accumulator.sum[k]);
+  }
 }
 
 
 void SparseLP::set_obj(int i, int v) {
-  if (solver == EXLP) {
+  if (backend.prob != NULL) backend.dirty_cols.push_back(i);
+  if (exact_storage(solver)) {
     objective[i] = v;
   } else {
     double_objective[i] = (double)v;
@@ -264,7 +431,8 @@ void SparseLP::set_obj(int i, int v) {
 }
 
 void SparseLP::set_obj(int i, double v) {
-  if (solver == EXLP) {
+  if (backend.prob != NULL) backend.dirty_cols.push_back(i);
+  if (exact_storage(solver)) {
     std::cout << "Can't input a double for rational LP\n";
   } else {
     double_objective[i] = v;
@@ -273,7 +441,8 @@ void SparseLP::set_obj(int i, double v) {
 
 
 void SparseLP::set_RHS(int i, Rational& r) {
-  if (solver == EXLP) {
+  if (backend.prob != NULL) backend.dirty_rows.push_back(i);
+  if (exact_storage(solver)) {
     if (r.d() != 1) {
       std::cout << "You can give a rational RHS, but it needs to be an integer\n";
       return;
@@ -285,7 +454,8 @@ void SparseLP::set_RHS(int i, Rational& r) {
 }
 
 void SparseLP::set_RHS(int i, int r) {
-  if (solver == EXLP) {
+  if (backend.prob != NULL) backend.dirty_rows.push_back(i);
+  if (exact_storage(solver)) {
     RHS[i] = r;
   } else {
     double_RHS[i] = (double)r;
@@ -293,7 +463,8 @@ void SparseLP::set_RHS(int i, int r) {
 }
 
 void SparseLP::set_RHS(int i, double r) {
-  if (solver == EXLP) {
+  if (backend.prob != NULL) backend.dirty_rows.push_back(i);
+  if (exact_storage(solver)) {
     std::cout << "Can't input a double for rational LP\n";
   } else {
     double_RHS[i] = r;
@@ -301,12 +472,13 @@ void SparseLP::set_RHS(int i, double r) {
 }
 
 void SparseLP::set_equality_type(int i, SparseLPEqualityType et) {
+  if (backend.prob != NULL) backend.dirty_rows.push_back(i);
   eq_type[i]= et;
 }
 
 
 int SparseLP::get_num_entries() {
-  if (solver == EXLP) {
+  if (exact_storage(solver)) {
     return (int)ar.size();
   } else {
     return (int)double_ar.size();
@@ -315,9 +487,22 @@ int SparseLP::get_num_entries() {
 
 
 void SparseLP::reset_num_entries(int i) {
+  if (by_columns) {
+    std::cout << "Can't remove entries from column storage\n";
+    return;
+  }
+  //remember where the loaded entries we're dropping were, so that 
+  //the backend model can be fixed up on the next solve
+  for (int j=i; j<backend.num_loaded_entries; ++j) {
+    backend.stale_ia.push_back(ia[j]);
+    backend.stale_ja.push_back(ja[j]);
+  }
+  if (i < backend.num_loaded_entries) {
+    backend.num_loaded_entries = i;
+  }
   ia.resize(i);
   ja.resize(i);
-  if (solver == EXLP) {
+  if (exact_storage(solver)) {
     ar.resize(i);
   } else {
     double_ar.resize(i);
@@ -327,7 +512,7 @@ void SparseLP::reset_num_entries(int i) {
 
 void SparseLP::get_soln_vector(std::vector<double>& sv) {
   sv.resize(num_cols);
-  if (solver == EXLP) {
+  if (exact_storage(solver)) {
     for (int i=0; i<num_cols; ++i) {
       sv[i] = soln_vector[i].get_d();
     }
@@ -340,7 +525,7 @@ void SparseLP::get_soln_vector(std::vector<double>& sv) {
 
 void SparseLP::get_soln_vector(std::vector<long double>& sv) {
   sv.resize(num_cols);
-  if (solver == EXLP) {
+  if (exact_storage(solver)) {
     for (int i=0; i<num_cols; ++i) {
       sv[i] = soln_vector[i].get_d();
     }
@@ -354,7 +539,7 @@ void SparseLP::get_soln_vector(std::vector<long double>& sv) {
 
 void SparseLP::get_soln_vector(std::vector<Rational>& sv) {
   sv.resize(num_cols);
-  if (solver == EXLP) {
+  if (exact_storage(solver)) {
     for (int i=0; i<num_cols; ++i) {
       sv[i] = soln_vector[i];
     }
@@ -365,8 +550,34 @@ void SparseLP::get_soln_vector(std::vector<Rational>& sv) {
   }
 }
 
+//the dual values for the rows, if the last solve found them (exlp 
+//doesn't, and neither does the hybrid solver if it fell back to exlp); 
+//they are for the objective as given, so the reduced cost of a column 
+//is its objective minus the dot product of the duals with the column
+void SparseLP::get_dual_vector(std::vector<double>& dv) {
+  if ((int)dual_vector.size() > 0) {
+    dv.resize(num_rows);
+    for (int i=0; i<num_rows; ++i) {
+      dv[i] = dual_vector[i].get_d();
+    }
+  } else {
+    dv = double_dual_vector;
+  }
+}
+
+void SparseLP::get_dual_vector(std::vector<Rational>& dv) {
+  if ((int)double_dual_vector.size() > 0) {
+    dv.resize(num_rows);
+    for (int i=0; i<num_rows; ++i) {
+      dv[i] = approx_rat(double_dual_vector[i]);
+    }
+  } else {
+    dv = dual_vector;
+  }
+}
+
 void SparseLP::get_optimal_value(double& ov) {
-  if (solver == EXLP) {
+  if (exact_storage(solver)) {
     //std::cout << "Getting double optimal value from EXLP?\n";
     ov = op_val.get_d();
   } else {
@@ -375,7 +586,7 @@ void SparseLP::get_optimal_value(double& ov) {
 }
 
 void SparseLP::get_optimal_value(Rational& ov) {
-  if (solver != EXLP) {
+  if (!exact_storage(solver)) {
     //std::cout << "Getting rational optimal value from non-EXLP?\n";
     ov = approx_rat(double_op_val);
   } else {
@@ -383,8 +594,698 @@ void SparseLP::get_optimal_value(Rational& ov) {
   }
 }
 
+//get the rows which contain an entry that was added or removed since 
+//the backend model was loaded, together with their full current 
+//contents (duplicate entries are summed, and removed entries show 
+//up with whatever value is left, possibly 0)
+void SparseLP::get_changed_rows(std::vector<int>& rows, 
+                                std::vector<std::vector<int> >& row_cols,
+                                std::vector<std::vector<double> >& row_vals) {
+  std::vector<int> row_slot(num_rows, -1);
+  rows.resize(0);
+  for (int i=0; i<(int)backend.stale_ia.size(); ++i) {
+    if (row_slot[backend.stale_ia[i]] == -1) {
+      row_slot[backend.stale_ia[i]] = rows.size();
+      rows.push_back(backend.stale_ia[i]);
+    }
+  }
+  for (int i=backend.num_loaded_entries; i<(int)ia.size(); ++i) {
+    if (row_slot[ia[i]] == -1) {
+      row_slot[ia[i]] = rows.size();
+      rows.push_back(ia[i]);
+    }
+  }
+  row_cols.assign(rows.size(), std::vector<int>(0));
+  row_vals.assign(rows.size(), std::vector<double>(0));
+  if ((int)rows.size() == 0) {
+    return;
+  }
+  for (int i=0; i<(int)backend.stale_ia.size(); ++i) {
+    row_cols[row_slot[backend.stale_ia[i]]].push_back(backend.stale_ja[i]);
+    row_vals[row_slot[backend.stale_ia[i]]].push_back(0);
+  }
+  for (int i=0; i<(int)ia.size(); ++i) {
+    if (row_slot[ia[i]] == -1) continue;
+    row_cols[row_slot[ia[i]]].push_back(ja[i]);
+    row_vals[row_slot[ia[i]]].push_back(double_ar[i]);
+  }
+  //merge the duplicate columns in each row
+  std::vector<int> col_pos(num_cols, -1);
+  for (int i=0; i<(int)rows.size(); ++i) {
+    std::vector<int> cols(0);
+    std::vector<double> vals(0);
+    for (int j=0; j<(int)row_cols[i].size(); ++j) {
+      int c = row_cols[i][j];
+      if (col_pos[c] == -1) {
+        col_pos[c] = cols.size();
+        cols.push_back(c);
+        vals.push_back(0);
+      }
+      vals[col_pos[c]] += row_vals[i][j];
+    }
+    for (int j=0; j<(int)cols.size(); ++j) {
+      col_pos[cols[j]] = -1;
+    }
+    row_cols[i] = cols;
+    row_vals[i] = vals;
+  }
+}
+
+
+static void set_glpk_col_bnds(glp_prob* lp, 
+                              int j, 
+                              SparseLPColumnBoundType t, 
+                              double b) {
+  switch (t) { 
+    case LB:
+      glp_set_col_bnds(lp, j+1, GLP_LO, b, b);
+      break;
+    case UB:
+      glp_set_col_bnds(lp, j+1, GLP_UP, b, b);
+      break;
+    case FREE:
+      glp_set_col_bnds(lp, j+1, GLP_FR, 0,0);
+      break;
+    case FIX:
+      glp_set_col_bnds(lp, j+1, GLP_FX, b, b);
+      break;
+  }
+}
+
+
+//put the (integer) entries in compressed column form, summing duplicates;
+//column j is csc_row/csc_value[csc_start[j]..csc_start[j+1]), and the 
+//vectors are only as long as the number of merged entries
+void SparseLP::get_csc_entries(std::vector<int>& csc_start, 
+                               std::vector<int>& csc_row, 
+                               std::vector<int>& csc_value) {
+  csc_start.assign(num_cols+1, 0);
+  csc_row.resize(ia.size());
+  csc_value.resize(ia.size());
+  for (int i=0; i<(int)ja.size(); ++i) {
+    csc_start[ja[i]+1]++;
+  }
+  for (int j=0; j<num_cols; ++j) {
+    csc_start[j+1] += csc_start[j];
+  }
+  std::vector<int> next_in_col(csc_start.begin(), csc_start.end()-1);
+  for (int i=0; i<(int)ia.size(); ++i) {
+    int k = next_in_col[ja[i]]++;
+    csc_row[k] = ia[i];
+    csc_value[k] = ar[i];
+  }
+  std::vector<int> row_pos(num_rows, -1);
+  int nnz = 0;
+  for (int j=0; j<num_cols; ++j) {
+    int col_begin = nnz;
+    for (int k=csc_start[j]; k<csc_start[j+1]; ++k) {
+      if (row_pos[csc_row[k]] >= col_begin) {
+        csc_value[row_pos[csc_row[k]]] += csc_value[k];
+      } else {
+        row_pos[csc_row[k]] = nnz;
+        csc_row[nnz] = csc_row[k];
+        csc_value[nnz] = csc_value[k];
+        nnz++;
+      }
+    }
+    csc_start[j] = col_begin;
+  }
+  csc_start[num_cols] = nnz;
+  csc_row.resize(nnz);
+  csc_value.resize(nnz);
+}
+
+
+//glpk only counts simplex iterations from 4.65 on; -1 means we can't tell
+static int glpk_iterations(glp_prob* lp) {
+#if GLP_MAJOR_VERSION > 4 || (GLP_MAJOR_VERSION == 4 && GLP_MINOR_VERSION >= 65)
+  return glp_get_it_cnt(lp);
+#else
+  (void)lp;
+  return -1;
+#endif
+}
+
+static void count_glpk_iterations(glp_prob* lp, int before) {
+  int after = glpk_iterations(lp);
+  if (after >= 0) {
+    STATS::add("lp_iterations", after - before);
+  }
+}
+
+SparseLPSolveCode SparseLP::solve_exlp(int verbose) {
+  
+  //exlp's solve_lp rewrites the problem in place (scaling, slacks, 
+  //artificials), so the model can't be kept around for a re-solve
+  
+  if (num_ints > 0) {
+    std::cout << "Integer programming not supported with exlp\n";
+    return LP_ERROR;
+  }
+  
+  //exlp init
+  mylib_init();
+  
+  LP* lp;
+  int  result;
+  char buf[100];
+  
+  if (verbose>1) 
+    std::cout << "About to create a new lp\n";    
+  lp = new_lp(NULL);
+  
+  if (verbose>1) 
+    std::cout << "Done\n";
+  
+  sprintf(buf, "scl");
+  lp_set_name(lp, buf);
+  
+  //the lp by default (set in lpstruct.c)
+  //has all the right stuff, I think
+  
+  //exlp loads the entries by index from compressed columns, so if 
+  //they were given as triplets, we convert them (summing duplicates)
+  std::vector<int> triplet_start;
+  std::vector<int> triplet_row;
+  std::vector<int> triplet_value;
+  if (by_columns) {
+    advance_column(num_cols);
+  } else {
+    get_csc_entries(triplet_start, triplet_row, triplet_value);
+  }
+  std::vector<int>& csc_start = (by_columns ? col_start : triplet_start);
+  std::vector<int>& csc_row = (by_columns ? row_index : triplet_row);
+  std::vector<int>& csc_value = (by_columns ? ar : triplet_value);
+  int nnz = csc_start[num_cols];
+  
+  lp_load_csc(lp, num_rows, num_cols, 
+              &csc_start[0], 
+              (nnz > 0 ? &csc_row[0] : NULL), 
+              (nnz > 0 ? &csc_value[0] : NULL),
+              (num_cols > 0 ? &objective[0] : NULL), 
+              (num_rows > 0 ? &RHS[0] : NULL));
+  
+  for (int i=0; i<num_rows; i++) {
+    switch (eq_type[i]) {
+      case EQ:
+        lp_set_row_equality(lp, i, 'E');
+        break;
+      case LE:
+        lp_set_row_equality(lp, i, 'L');
+        break;
+      case GE:
+        lp_set_row_equality(lp, i, 'G');
+        break;
+    }
+  }
+  
+  //lp->maximize is false, so we reverse the sign
+  vector_rev_sgn(lp->c);
+  
+  if (verbose>1) {
+    std::cout << "Rows: " << lp->rows << "\n";;
+    std::cout << "Vars: " << lp->vars << "\n";
+  }
+  
+  
+  result = solve_lp(lp);
+  
+  if (result != LP_RESULT_OPTIMAL) {
+    //std::cout << "got error code " << result << "\n";
+    if (result == 2) {
+      lp_free(lp);
+      return LP_INFEASIBLE;
+    } else {
+      lp_free(lp);
+      return LP_ERROR;
+    }
+  }
+  
+  mpq_t entry;
+  mpq_init(entry);
+  
+  lp_get_object_value(lp, &entry);
+  
+  op_val = Rational(entry)/Rational(4,1);
+  
+  for (int i=0; i<num_cols; i++) {
+    mpq_set(entry, *vector_get_element_ptr(lp->x, i));
+    soln_vector[i] = Rational(entry);
+  }
+  
+  mpq_clear(entry);
+  lp_free(lp);
+  
+  return LP_OPTIMAL;
+}
+
+
+/*****************************************************************************
+ * exact arithmetic for the hybrid solver: glpk finds a basis in floating 
+ * point, and we check it (and, if need be, pivot it to optimality) over Q
+ * ***************************************************************************/
+
+//a basis B is factored as E B = U, where E is the product of the row 
+//operations in L (at step k, subtract f times row pivot_row[k] from row r, 
+//for each (r,f) in L[k]), and U[k] is row pivot_row[k] of U, which has 
+//its pivot in column pivot_col[k] and is zero in the earlier pivot columns
+struct ExactLU {
+  int m;
+  std::vector<int> pivot_row;
+  std::vector<int> pivot_col;
+  std::vector<std::vector<std::pair<int, Rational> > > U;
+  std::vector<std::vector<std::pair<int, Rational> > > L;
+  
+  bool factor(int n, std::vector<std::vector<std::pair<int, Rational> > >& cols);
+  void solve(std::vector<Rational>& z);
+  void solve_transpose(std::vector<Rational>& y);
+};
+
+//move column j to its new place in the order after adding or removing row r
+static void update_col_count(std::set<std::pair<int,int> >& col_order,
+                             std::vector<std::set<int> >& col_rows,
+                             int j, int r, bool add) {
+  col_order.erase(std::make_pair((int)col_rows[j].size(), j));
+  if (add) {
+    col_rows[j].insert(r);
+  } else {
+    col_rows[j].erase(r);
+  }
+  col_order.insert(std::make_pair((int)col_rows[j].size(), j));
+}
+
+//factor the n x n matrix with the given (sparse) columns; we always pivot 
+//in the active column with the fewest entries, and in the shortest row 
+//of that column, to keep the fill down.  Returns false if it's singular
+bool ExactLU::factor(int n, 
+                     std::vector<std::vector<std::pair<int, Rational> > >& cols) {
+  m = n;
+  pivot_row.resize(0);
+  pivot_col.resize(0);
+  U.resize(0);
+  L.resize(0);
+  std::vector<std::map<int, Rational> > rows(m);
+  std::vector<std::set<int> > col_rows(m);
+  for (int j=0; j<m; ++j) {
+    for (int k=0; k<(int)cols[j].size(); ++k) {
+      if (cols[j][k].second == 0) continue;
+      rows[cols[j][k].first][j] = cols[j][k].second;
+      col_rows[j].insert(cols[j][k].first);
+    }
+  }
+  std::set<std::pair<int,int> > col_order;
+  for (int j=0; j<m; ++j) {
+    col_order.insert(std::make_pair((int)col_rows[j].size(), j));
+  }
+  for (int step=0; step<m; ++step) {
+    int c = col_order.begin()->second;
+    if ((int)col_rows[c].size() == 0) {
+      return false;
+    }
+    col_order.erase(col_order.begin());
+    int p = -1;
+    for (std::set<int>::iterator it=col_rows[c].begin(); it!=col_rows[c].end(); ++it) {
+      if (p == -1 || rows[*it].size() < rows[p].size()) {
+        p = *it;
+      }
+    }
+    Rational piv = rows[p][c];
+    //freeze the pivot row
+    U.push_back(std::vector<std::pair<int, Rational> >(rows[p].begin(), rows[p].end()));
+    std::vector<std::pair<int, Rational> >& prow = U.back();
+    for (int k=0; k<(int)prow.size(); ++k) {
+      if (prow[k].first != c) {
+        update_col_count(col_order, col_rows, prow[k].first, p, false);
+      }
+    }
+    col_rows[c].erase(p);
+    rows[p].clear();
+    //eliminate column c from the other active rows
+    L.push_back(std::vector<std::pair<int, Rational> >(0));
+    std::vector<int> others(col_rows[c].begin(), col_rows[c].end());
+    for (int i=0; i<(int)others.size(); ++i) {
+      int r = others[i];
+      Rational f = rows[r][c] / piv;
+      L.back().push_back(std::make_pair(r, f));
+      rows[r].erase(c);
+      for (int k=0; k<(int)prow.size(); ++k) {
+        int j = prow[k].first;
+        if (j == c) continue;
+        std::map<int, Rational>::iterator e = rows[r].find(j);
+        if (e == rows[r].end()) {
+          rows[r][j] = -(f*prow[k].second);
+          update_col_count(col_order, col_rows, j, r, true);
+        } else {
+          e->second = e->second - f*prow[k].second;
+          if (e->second == 0) {
+            rows[r].erase(e);
+            update_col_count(col_order, col_rows, j, r, false);
+          }
+        }
+      }
+    }
+    col_rows[c].clear();
+    pivot_row.push_back(p);
+    pivot_col.push_back(c);
+  }
+  return true;
+}
+
+//replace z (indexed by row) with the solution of B x = z (indexed by column)
+void ExactLU::solve(std::vector<Rational>& z) {
+  for (int k=0; k<m; ++k) {
+    int p = pivot_row[k];
+    if (z[p] == 0) continue;
+    for (int i=0; i<(int)L[k].size(); ++i) {
+      z[L[k][i].first] = z[L[k][i].first] - L[k][i].second*z[p];
+    }
+  }
+  std::vector<Rational> x(m);
+  for (int k=m-1; k>=0; --k) {
+    int c = pivot_col[k];
+    Rational s = z[pivot_row[k]];
+    Rational piv;
+    for (int i=0; i<(int)U[k].size(); ++i) {
+      if (U[k][i].first == c) {
+        piv = U[k][i].second;
+      } else {
+        s = s - U[k][i].second*x[U[k][i].first];
+      }
+    }
+    x[c] = s/piv;
+  }
+  z = x;
+}
+
+//replace y (indexed by column) with the solution of B^T w = y (by row)
+void ExactLU::solve_transpose(std::vector<Rational>& y) {
+  //U by columns: the steps whose row meets each column
+  std::vector<std::vector<std::pair<int, Rational> > > U_cols(m);
+  std::vector<Rational> pivots(m);
+  for (int k=0; k<m; ++k) {
+    for (int i=0; i<(int)U[k].size(); ++i) {
+      if (U[k][i].first == pivot_col[k]) {
+        pivots[k] = U[k][i].second;
+      } else {
+        U_cols[U[k][i].first].push_back(std::make_pair(k, U[k][i].second));
+      }
+    }
+  }
+  std::vector<Rational> w(m);
+  for (int k=0; k<m; ++k) {
+    int c = pivot_col[k];
+    Rational s = y[c];
+    for (int i=0; i<(int)U_cols[c].size(); ++i) {
+      s = s - U_cols[c][i].second*w[pivot_row[U_cols[c][i].first]];
+    }
+    w[pivot_row[k]] = s/pivots[k];
+  }
+  for (int k=m-1; k>=0; --k) {
+    int p = pivot_row[k];
+    for (int i=0; i<(int)L[k].size(); ++i) {
+      w[p] = w[p] - L[k][i].second*w[L[k][i].first];
+    }
+  }
+  y = w;
+}
+
+//the column of variable v in [A -I]: the structural variables come first, 
+//then the auxiliary variable r_i = (row i of A) x for each row
+static void exact_column(int v, int num_cols, 
+                         std::vector<int>& csc_start,
+                         std::vector<int>& csc_row,
+                         std::vector<int>& csc_value,
+                         std::vector<std::pair<int, Rational> >& col) {
+  col.resize(0);
+  if (v < num_cols) {
+    for (int k=csc_start[v]; k<csc_start[v+1]; ++k) {
+      col.push_back(std::make_pair(csc_row[k], Rational(csc_value[k])));
+    }
+  } else {
+    col.push_back(std::make_pair(v-num_cols, Rational(-1)));
+  }
+}
+
+#define MAX_EXACT_PIVOTS 200
+
+SparseLPSolveCode SparseLP::solve_glpk_exact(int verbose) {
+  
+  if (num_ints > 0) {
+    std::cout << "Integer programming not supported with exact arithmetic\n";
+    return LP_ERROR;
+  }
+  
+  std::vector<int> triplet_start;
+  std::vector<int> triplet_row;
+  std::vector<int> triplet_value;
+  if (by_columns) {
+    advance_column(num_cols);
+  } else {
+    get_csc_entries(triplet_start, triplet_row, triplet_value);
+  }
+  std::vector<int>& csc_start = (by_columns ? col_start : triplet_start);
+  std::vector<int>& csc_row = (by_columns ? row_index : triplet_row);
+  std::vector<int>& csc_value = (by_columns ? ar : triplet_value);
+  
+  //as with exlp, the columns are all x >= 0
+  glp_prob* lp = glp_create_prob();
+  glp_set_prob_name(lp, "scl");
+  glp_set_obj_dir(lp, GLP_MIN);
+  glp_add_rows(lp, num_rows);
+  glp_add_cols(lp, num_cols);
+  for (int i=0; i<num_rows; ++i) {
+    switch (eq_type[i]) {
+      case EQ:
+        glp_set_row_bnds(lp, i+1, GLP_FX, RHS[i], RHS[i]);
+        break;
+      case LE:
+        glp_set_row_bnds(lp, i+1, GLP_UP, RHS[i], RHS[i]);
+        break;
+      case GE:
+        glp_set_row_bnds(lp, i+1, GLP_LO, RHS[i], RHS[i]);
+        break;
+    }
+  }
+  std::vector<int> ind(num_rows+1);
+  std::vector<double> val(num_rows+1);
+  for (int j=0; j<num_cols; ++j) {
+    glp_set_col_bnds(lp, j+1, GLP_LO, 0.0, 0.0);
+    glp_set_obj_coef(lp, j+1, objective[j]);
+    int len = 0;
+    for (int k=csc_start[j]; k<csc_start[j+1]; ++k) {
+      if (csc_value[k] == 0) continue;
+      len++;
+      ind[len] = csc_row[k]+1;
+      val[len] = csc_value[k];
+    }
+    glp_set_mat_col(lp, j+1, len, &ind[0], &val[0]);
+  }
+  
+  glp_smcp parm;
+  glp_init_smcp(&parm);
+  parm.presolve = GLP_ON;
+  parm.msg_lev = (verbose > 1 ? GLP_MSG_ALL : GLP_MSG_OFF);
+  int iterations = glpk_iterations(lp);
+  int ret = glp_simplex(lp, &parm);
+  count_glpk_iterations(lp, iterations);
+  int stat = glp_get_status(lp);
+  if (ret != 0 || stat != GLP_OPT) {
+    glp_delete_prob(lp);
+    if (verbose > 1) {
+      std::cout << "glpk didn't find an optimal basis (status " << stat 
+                << "); solving with exlp\n";
+    }
+    return solve_exlp(verbose);
+  }
+  
+  //variable j < num_cols is a column, and num_cols+i is the row i slack
+  int m = num_rows;
+  int n = num_cols;
+  std::vector<int> basis(0);
+  std::vector<bool> is_basic(n+m, false);
+  for (int j=0; j<n; ++j) {
+    if (glp_get_col_stat(lp, j+1) == GLP_BS) {
+      basis.push_back(j);
+      is_basic[j] = true;
+    }
+  }
+  for (int i=0; i<m; ++i) {
+    if (glp_get_row_stat(lp, i+1) == GLP_BS) {
+      basis.push_back(n+i);
+      is_basic[n+i] = true;
+    }
+  }
+  glp_delete_prob(lp);
+  if ((int)basis.size() != m) {
+    if (verbose > 1) {
+      std::cout << "glpk basis has the wrong size; solving with exlp\n";
+    }
+    return solve_exlp(verbose);
+  }
+  
+  //nonbasic columns are at 0, and nonbasic slacks are at their RHS; 
+  //we do primal simplex pivots with Bland's rule until the reduced 
+  //costs are all of the right sign
+  ExactLU lu;
+  std::vector<std::vector<std::pair<int, Rational> > > B(m);
+  std::vector<std::pair<int, Rational> > col;
+  std::vector<Rational> x_B(m);
+  std::vector<Rational> y(m);
+  std::vector<Rational> w(m);
+  int num_pivots;
+  for (num_pivots=0; ; ++num_pivots) {
+    for (int k=0; k<m; ++k) {
+      exact_column(basis[k], n, csc_start, csc_row, csc_value, B[k]);
+    }
+    if (!lu.factor(m, B)) {
+      if (verbose > 1) {
+        std::cout << "Basis is singular over Q; solving with exlp\n";
+      }
+      return solve_exlp(verbose);
+    }
+    for (int i=0; i<m; ++i) {
+      x_B[i] = (is_basic[n+i] ? Rational(0) : Rational(RHS[i]));
+    }
+    lu.solve(x_B);
+    
+    //glpk's basis must at least be feasible
+    if (num_pivots == 0) {
+      bool feasible = true;
+      for (int k=0; k<m && feasible; ++k) {
+        if (basis[k] < n) {
+          feasible = !(x_B[k] < 0);
+        } else {
+          int i = basis[k]-n;
+          feasible = (eq_type[i] == EQ ? x_B[k] == RHS[i] : 
+                      (eq_type[i] == LE ? !(x_B[k] > RHS[i]) : !(x_B[k] < RHS[i])));
+        }
+      }
+      if (!feasible) {
+        if (verbose > 1) {
+          std::cout << "glpk basis isn't feasible over Q; solving with exlp\n";
+        }
+        return solve_exlp(verbose);
+      }
+    }
+    
+    //the duals and reduced costs; find the first improving variable
+    for (int k=0; k<m; ++k) {
+      y[k] = (basis[k] < n ? Rational(objective[basis[k]]) : Rational(0));
+    }
+    lu.solve_transpose(y);
+    int entering = -1;
+    int dir = 1;
+    for (int j=0; j<n && entering == -1; ++j) {
+      if (is_basic[j]) continue;
+      Rational d(objective[j]);
+      for (int k=csc_start[j]; k<csc_start[j+1]; ++k) {
+        d = d - y[csc_row[k]]*csc_value[k];
+      }
+      if (d < 0) {
+        entering = j;
+      }
+    }
+    for (int i=0; i<m && entering == -1; ++i) {
+      if (is_basic[n+i] || eq_type[i] == EQ) continue;
+      if (eq_type[i] == LE && y[i] > 0) {
+        entering = n+i;
+        dir = -1;
+      } else if (eq_type[i] == GE && y[i] < 0) {
+        entering = n+i;
+      }
+    }
+    if (entering == -1) {
+      break;
+    }
+    
+    if (num_pivots == MAX_EXACT_PIVOTS) {
+      if (verbose > 1) {
+        std::cout << "Too many exact pivots; solving with exlp\n";
+      }
+      return solve_exlp(verbose);
+    }
+    
+    //ratio test: moving the entering variable by dir*t changes the 
+    //basic variables by -dir*t*w, where B w is its column
+    exact_column(entering, n, csc_start, csc_row, csc_value, col);
+    for (int i=0; i<m; ++i) {
+      w[i] = 0;
+    }
+    for (int i=0; i<(int)col.size(); ++i) {
+      w[col[i].first] = col[i].second;
+    }
+    lu.solve(w);
+    int leaving = -1;
+    Rational best_t;
+    for (int k=0; k<m; ++k) {
+      if (w[k] == 0) continue;
+      bool decreasing = (dir == 1 ? w[k] > 0 : w[k] < 0);
+      Rational rate = (w[k] < 0 ? -w[k] : w[k]);
+      Rational t;
+      if (basis[k] < n) {
+        if (!decreasing) continue;
+        t = x_B[k] / rate;
+      } else {
+        int i = basis[k]-n;
+        if (eq_type[i] == EQ) {
+          t = 0;
+        } else if (eq_type[i] == LE && !decreasing) {
+          t = (Rational(RHS[i]) - x_B[k]) / rate;
+        } else if (eq_type[i] == GE && decreasing) {
+          t = (x_B[k] - Rational(RHS[i])) / rate;
+        } else {
+          continue;
+        }
+      }
+      if (leaving == -1 || t < best_t || 
+          (t == best_t && basis[k] < basis[leaving])) {
+        leaving = k;
+        best_t = t;
+      }
+    }
+    if (leaving == -1) {
+      std::cout << "LP is unbounded\n";
+      return LP_ERROR;
+    }
+    is_basic[basis[leaving]] = false;
+    is_basic[entering] = true;
+    basis[leaving] = entering;
+  }
+  
+  if (verbose > 1) {
+    std::cout << "Certified glpk basis over Q after " << num_pivots 
+              << " exact pivots\n";
+  }
+  STATS::add("lp_exact_pivots", num_pivots);
+  
+  op_val = Rational(0);
+  for (int j=0; j<n; ++j) {
+    soln_vector[j] = Rational(0);
+  }
+  for (int k=0; k<m; ++k) {
+    if (basis[k] < n) {
+      soln_vector[basis[k]] = x_B[k];
+      op_val += x_B[k]*objective[basis[k]];
+    }
+  }
+  op_val /= 4;
+  dual_vector = y;
+  
+  return LP_OPTIMAL;
+}
+
+
 SparseLPSolveCode SparseLP::solve(int verbose) {
   
+  dual_vector.resize(0);
+  double_dual_vector.resize(0);
+  
+  STATS::add("lp_solves", 1);
+  //with column generation there are several LPs; we report the largest
+  STATS::max("lp_rows", num_rows);
+  STATS::max("lp_cols", num_cols);
+  STATS::max("lp_nonzeros", get_num_entries());
+  
   /************************************  GLPK *******************************/ 
   
   if (solver == GLPK || solver == GLPK_SIMPLEX || solver == GLPK_IPT) {   
@@ -394,71 +1295,144 @@ SparseLPSolveCode SparseLP::solve(int verbose) {
     glp_iptcp ipt_parm;
     glp_iocp int_parm;
     
-    lp = glp_create_prob();
-    
-    glp_set_prob_name(lp, "scl");
-    glp_set_obj_dir(lp, GLP_MIN);
-    
-    glp_add_rows(lp, num_rows );
-    
-    glp_add_cols(lp, num_cols);
+    //if we have solved before, the model is still loaded, and 
+    //we only need to push the changes
+    bool warm_start = backend.is_loaded(solver);
     
-    for (int i=0; i<num_rows; i++) {
-      glp_set_row_bnds(lp, i+1, GLP_FX, double_RHS[i], double_RHS[i]);
-    }
-    if ((int)col_bounds.size() == 0) {
-      for (int i=0; i<num_cols; i++) {
-        glp_set_col_bnds(lp, i+1, GLP_LO, 0.0, 0.0);
-        glp_set_obj_coef(lp, i+1, double_objective[i]);
+    if (!warm_start) {
+      backend.clear();
+      
+      lp = glp_create_prob();
+      
+      glp_set_prob_name(lp, "scl");
+      glp_set_obj_dir(lp, GLP_MIN);
+      
+      glp_add_rows(lp, num_rows );
+      
+      glp_add_cols(lp, num_cols);
+      
+      for (int i=0; i<num_rows; i++) {
+        glp_set_row_bnds(lp, i+1, GLP_FX, double_RHS[i], double_RHS[i]);
+      }
+      if ((int)col_bounds.size() == 0) {
+        for (int i=0; i<num_cols; i++) {
+          glp_set_col_bnds(lp, i+1, GLP_LO, 0.0, 0.0);
+          glp_set_obj_coef(lp, i+1, double_objective[i]);
+        }
+      } else {
+        for (int i=0; i<num_cols; i++) {
+          set_glpk_col_bnds(lp, i, col_bound_types[i], col_bounds_double[i]);
+          glp_set_obj_coef(lp, i+1, double_objective[i]);
+        }
       }
+      if (by_columns) {
+        //glpk wants 1-based arrays, so we go a column at a time
+        advance_column(num_cols);
+        std::vector<int> ind(num_rows+1);
+        std::vector<double> val(num_rows+1);
+        for (int j=0; j<num_cols; ++j) {
+          int len = col_start[j+1]-col_start[j];
+          for (int k=0; k<len; ++k) {
+            ind[k+1] = row_index[col_start[j]+k]+1;
+            val[k+1] = double_ar[col_start[j]+k];
+          }
+          glp_set_mat_col(lp, j+1, len, &ind[0], &val[0]);
+        }
+      } else {
+        //rearrange
+        ia.push_back(0);
+        ja.push_back(0);
+        double_ar.push_back(0);
+        for (int i=ia.size()-1; i>0; --i) {
+          ia[i] = ia[i-1]+1;
+          ja[i] = ja[i-1]+1;
+          double_ar[i] = double_ar[i-1];
+        }
+        glp_load_matrix(lp, ia.size()-1, &ia[0], &ja[0], &double_ar[0]);
+        //unrearrange
+        for (int i=0; i<(int)ia.size()-1; ++i) {
+          ia[i] = ia[i+1]-1;
+          ja[i] = ja[i+1]-1;
+          double_ar[i] = double_ar[i+1];
+        }    
+        ia.pop_back();
+        ja.pop_back();
+        double_ar.pop_back();
+      }
+      
+      backend.prob = (void*)lp;
+      backend.solver = solver;
+      
     } else {
-      for (int i=0; i<num_cols; i++) {
-        switch (col_bound_types[i]) { 
-          case LB:
-            glp_set_col_bnds(lp, i+1, GLP_LO, col_bounds_double[i], col_bounds_double[i]);
-            break;
-          case UB:
-            glp_set_col_bnds(lp, i+1, GLP_UP, col_bounds_double[i], col_bounds_double[i]);
-            break;
-          case FREE:
-            glp_set_col_bnds(lp, i+1, GLP_FR, 0,0);
-            break;
-          case FIX:
-            glp_set_col_bnds(lp, i+1, GLP_FX, col_bounds_double[i], col_bounds_double[i]);
-            break;
+      lp = (glp_prob*)backend.prob;
+      
+      for (int i=0; i<(int)backend.dirty_rows.size(); ++i) {
+        int r = backend.dirty_rows[i];
+        glp_set_row_bnds(lp, r+1, GLP_FX, double_RHS[r], double_RHS[r]);
+      }
+      for (int i=0; i<(int)backend.dirty_cols.size(); ++i) {
+        int c = backend.dirty_cols[i];
+        if ((int)col_bounds.size() == 0) {
+          glp_set_col_bnds(lp, c+1, GLP_LO, 0.0, 0.0);
+        } else {
+          set_glpk_col_bnds(lp, c, col_bound_types[c], col_bounds_double[c]);
+        }
+        glp_set_obj_coef(lp, c+1, double_objective[c]);
+      }
+      
+      std::vector<int> rows;
+      std::vector<std::vector<int> > row_cols;
+      std::vector<std::vector<double> > row_vals;
+      get_changed_rows(rows, row_cols, row_vals);
+      std::vector<int> ind;
+      std::vector<double> val;
+      for (int i=0; i<(int)rows.size(); ++i) {
+        //glpk wants 1-based arrays, and no zeros
+        ind.resize(1);
+        val.resize(1);
+        for (int j=0; j<(int)row_cols[i].size(); ++j) {
+          if (row_vals[i][j] == 0) continue;
+          ind.push_back(row_cols[i][j]+1);
+          val.push_back(row_vals[i][j]);
         }
-        glp_set_obj_coef(lp, i+1, double_objective[i]);
-      }
-    }
-    //rearrange
-    ia.push_back(0);
-    ja.push_back(0);
-    double_ar.push_back(0);
-    for (int i=ia.size()-1; i>0; --i) {
-      ia[i] = ia[i-1]+1;
-      ja[i] = ja[i-1]+1;
-      double_ar[i] = double_ar[i-1];
-    }
-    glp_load_matrix(lp, ia.size()-1, &ia[0], &ja[0], &double_ar[0]);
-    //unrearrange
-    for (int i=0; i<(int)ia.size()-1; ++i) {
-      ia[i] = ia[i+1]-1;
-      ja[i] = ja[i+1]-1;
-      double_ar[i] = double_ar[i+1];
-    }    
-    ia.pop_back();
-    ja.pop_back();
-    double_ar.pop_back();
+        glp_set_mat_row(lp, rows[i]+1, (int)ind.size()-1, &ind[0], &val[0]);
+      }
+      
+      if (verbose > 1) {
+        std::cout << "Warm start: changed " << backend.dirty_rows.size() 
+                  << " row bounds, " << backend.dirty_cols.size() 
+                  << " columns, and " << rows.size() << " matrix rows\n";
+      }
+    }
+    
+    backend.num_loaded_entries = ia.size();
+    backend.stale_ia.resize(0);
+    backend.stale_ja.resize(0);
+    backend.dirty_rows.resize(0);
+    backend.dirty_cols.resize(0);
     
     if (num_ints==0 && (solver == GLPK || solver == GLPK_SIMPLEX)) {
       glp_init_smcp(&parm);
-      parm.presolve=GLP_ON;
+      if (warm_start) {
+        //start from the last optimal basis; after a change to the RHS 
+        //it's still dual feasible, so the dual simplex is the right thing
+        parm.presolve = GLP_OFF;
+        parm.meth = GLP_DUALP;
+      } else {
+        parm.presolve=GLP_ON;
+      }
       if (verbose > 1) {
         parm.msg_lev = GLP_MSG_ALL;
       } else {
         parm.msg_lev = GLP_MSG_OFF;
       }
-      glp_simplex(lp, &parm);
+      int iterations = glpk_iterations(lp);
+      if (glp_simplex(lp, &parm) != 0 && warm_start) {
+        //the old basis didn't survive the changes to the matrix
+        glp_adv_basis(lp, 0);
+        glp_simplex(lp, &parm);
+      }
+      count_glpk_iterations(lp, iterations);
       
     } else if (num_ints == 0 && solver == GLPK_IPT) {
       glp_init_iptcp(&ipt_parm);
@@ -497,12 +1471,10 @@ SparseLPSolveCode SparseLP::solve(int verbose) {
     }
     if (stat != GLP_OPT) {
       if (stat == GLP_NOFEAS || stat == GLP_UNDEF) {
-        glp_delete_prob(lp);
         return LP_INFEASIBLE;
       } else {
         std::cout << "GLPK Linear programming error: " << stat << "\n";
       }
-      glp_delete_prob(lp);
       return LP_ERROR;
     }
     
@@ -542,171 +1514,26 @@ SparseLPSolveCode SparseLP::solve(int verbose) {
       }	
     }
     
-	  glp_delete_prob(lp);
-	  
-  /***************************************  EXLP ****************************/  
-    
-	  
-	} else if (solver == EXLP) {
-    
-    if (num_ints > 0) {
-      std::cout << "Integer programming not supported with exlp\n";
-      return LP_ERROR;
-    }
-    
-    //exlp init
-	  mylib_init();
-	  
-	  LP* lp;
-    int  result;
-    char buf[100];
-    int varNum;
-    
-    if (verbose>1) 
-      std::cout << "About to create a new lp\n";    
-    lp = new_lp(NULL);
-    
-    if (verbose>1) 
-      std::cout << "Done\n";
-    
-    if (verbose>1)
-      std::cout << "Init hash\n";
-    
-    lp_hash_str_init(lp, lp->hash_entries);
-    //my_hash_mpq_init(lp->hash_entries);
-    
-    if (verbose>1)
-      std::cout << "Done\n";
-    
-    
-    sprintf(buf, "scl");
-    lp_set_name(lp, buf);
-    
-    //the lp by default (set in lpstruct.c)
-    //has all the right stuff, I think
-    
-    //now we input the rows -- it likes to name them
-    for (int i=0; i<num_rows; i++) {
-      sprintf(buf, "r%d", i);
-      lp_add_row(lp, buf);
-      switch (eq_type[i]) {
-        case EQ:
-          lp_set_row_equality(lp, lp_get_row_num(lp, buf), 'E');
-          break;
-        case LE:
-          lp_set_row_equality(lp, lp_get_row_num(lp, buf), 'L');
-          break;
-        case GE:
-          lp_set_row_equality(lp, lp_get_row_num(lp, buf), 'G');
-          break;
-      }
-    }
-    
-    if (verbose>1) {
-      std::cout << "Entered the row names and equalities\n";
-    }
-    
-    //add the objective function row
-    sprintf(buf, "obj");
-    lp_set_obj_name(lp, buf);
-    
-    int* columnIndices = new int[num_cols]; //this is probably useless
-    int rowNum;
-    int objectiveIndex = lp_get_row_num(lp, (char*)"obj");
-    mpq_t entry;
-    mpq_init(entry);
-    
-    for (int i=0; i<num_cols; i++) {
-      //since we only enter entries from a column once, we only need to do this once,
-      //as opposed to read_columns in mps.c
-      sprintf(buf, "col%d", i);
-      varNum = lp_add_var_without_A(lp, buf);
-      columnIndices[i] = varNum;
-      
-      //for (j=0; j<nRows; j++) {
-      //we're going to enter something in the varNum column, in the right row
-      //with coefficient from constraints, but we will know what to do 
-      //}
-    }
-    
-    if (verbose>1) {
-      std::cout << "Added the columns\n";
-    }
-    
-    //this is from mps.c
-    matrix_resize(lp->A, lp->rows, lp->vars);
-    vector_resize(lp->b, lp->rows);
-    vector_resize(lp->xb, lp->rows);
-    vector_resize(lp->cb, lp->rows);
-    
-    
-    //now we actually enter the data
-    for (int i=0; i<(int)ia.size(); ++i) {
-      varNum = columnIndices[ja[i]];
-      sprintf(buf, "r%d", ia[i]);
-      rowNum = lp_get_row_num(lp, buf);
-      mpq_set_si(entry, ar[i], 1);
-      lp_set_coefficient(lp, entry, rowNum, varNum);
-    }
-    
-    //set the objective function
-    for (int i=0; i<num_cols; ++i) {
-      varNum = columnIndices[i];
-      mpq_set_si(entry, objective[i], 1);
-      lp_set_coefficient(lp, entry, objectiveIndex, varNum);
-    }
-    
-    //lp->maximize is false, so we reverse the sign
-    vector_rev_sgn(lp->c);
-    
-    //set the right hand sides for the arcs
-    for (int i=0; i<num_rows; ++i) {
-      sprintf(buf, "r%d", i);
-      rowNum = lp_get_row_num(lp, buf);
-      mpq_set_si(entry, RHS[i], 1);
-      lp_set_rhs(lp, rowNum, entry);
-    }
-    
-    //read the bounds on the columns
-    mpq_set_si(entry, 0,1);
-    for (int i=0; i<num_cols; i++) {
-      varNum = columnIndices[i];
-      if (lp->lower.is_valid[varNum] == FALSE) //this will always be the case I think
-        mpq_init(lp->lower.bound[varNum]);
-      mpq_set(lp->lower.bound[varNum], entry);
-      lp->lower.is_valid[varNum] = TRUE;
-    }
-    
-    if (verbose>1) {
-      std::cout << "Rows: " << lp->rows << "\n";;
-      std::cout << "Vars: " << lp->vars << "\n";
-    }
-    
-    
-    result = solve_lp(lp);
-    
-    if (result != LP_RESULT_OPTIMAL) {
-      //std::cout << "got error code " << result << "\n";
-      if (result == 2) {
-        lp_free(lp);
-        return LP_INFEASIBLE;
-      } else {
-        lp_free(lp);
-        return LP_ERROR;
+    if (num_ints == 0) {
+      double_dual_vector.resize(num_rows);
+      for (int i=0; i<num_rows; i++) {
+        double_dual_vector[i] = (solver == GLPK_IPT ? glp_ipt_row_dual(lp,i+1) 
+                                                    : glp_get_row_dual(lp,i+1));
       }
     }
     
-    lp_get_object_value(lp, &entry);
+  /***************************************  EXLP ****************************/  
     
-    op_val = Rational(entry)/Rational(4,1);
+	  
+	} else if (solver == EXLP) {
     
-    for (int i=0; i<num_cols; i++) {
-      mpq_set(entry, *vector_get_element_ptr(lp->x, columnIndices[i]));
-      soln_vector[i] = Rational(entry);
-    }
+    return solve_exlp(verbose);
     
-    lp_free(lp);
+  /*********************************  GLPK + exact *************************/
+  
+  } else if (solver == GLPK_EXACT) {
     
+    return solve_glpk_exact(verbose);
     
     
  /************************  GUROBI *******************************************/   
@@ -726,51 +1553,144 @@ SparseLPSolveCode SparseLP::solve(int verbose) {
         
     GRBenv   *env   = NULL;
     GRBmodel *model = NULL;
-    GRBloadenv( &env, "gurobi.log" );
     
-    std::vector<double> lb(0);
-    std::vector<double> ub(0);
-    if ((int)col_bound_types.size() != 0) {
-      lb.resize(num_cols);
-      ub.resize(num_cols);
-      for (int i=0; i<num_cols; ++i) {
-        lb[i] = (col_bound_types[i]  == UB || col_bound_types[i] == FREE ? -GRB_INFINITY : col_bounds_double[i]);
-        ub[i] = (col_bound_types[i]  == LB || col_bound_types[i] == FREE ? GRB_INFINITY : col_bounds_double[i]);
+    if (!backend.is_loaded(solver)) {
+      backend.clear();
+      
+      GRBloadenv( &env, "gurobi.log" );
+      
+      std::vector<double> lb(0);
+      std::vector<double> ub(0);
+      if ((int)col_bound_types.size() != 0) {
+        lb.resize(num_cols);
+        ub.resize(num_cols);
+        for (int i=0; i<num_cols; ++i) {
+          lb[i] = (col_bound_types[i]  == UB || col_bound_types[i] == FREE ? -GRB_INFINITY : col_bounds_double[i]);
+          ub[i] = (col_bound_types[i]  == LB || col_bound_types[i] == FREE ? GRB_INFINITY : col_bounds_double[i]);
+        }
       }
-    }
-    double* lb_pointer = ((int)col_bound_types.size() == 0 ? NULL : &lb[0]);
-    double* ub_pointer = ((int)col_bound_types.size() == 0 ? NULL : &ub[0]);
+      double* lb_pointer = ((int)col_bound_types.size() == 0 ? NULL : &lb[0]);
+      double* ub_pointer = ((int)col_bound_types.size() == 0 ? NULL : &ub[0]);
+        
+      
+      if (by_columns) {
+        //gurobi takes the compressed columns as they are
+        advance_column(num_cols);
+        std::vector<int> col_len(num_cols);
+        for (int j=0; j<num_cols; ++j) {
+          col_len[j] = col_start[j+1]-col_start[j];
+        }
+        std::vector<char> sense(num_rows);
+        for (int i=0; i<num_rows; ++i) {
+          sense[i] = (eq_type[i] == EQ ? GRB_EQUAL : 
+                      (eq_type[i] == LE ? GRB_LESS_EQUAL : GRB_GREATER_EQUAL));
+        }
+        std::vector<char> var_types(0);
+        if (num_ints > 0) {
+          var_types.resize(num_cols);
+          for (int i=0; i<num_cols; ++i) {
+            var_types[i] = (col_type[i] == REAL ? GRB_CONTINUOUS : GRB_INTEGER);
+          }
+        }
+        GRBloadmodel( env, &model, "scl", num_cols, num_rows, GRB_MINIMIZE, 0.0, 
+                      &double_objective[0], &sense[0], &double_RHS[0], 
+                      &col_start[0], &col_len[0], 
+                      ((int)row_index.size() > 0 ? &row_index[0] : NULL), 
+                      ((int)double_ar.size() > 0 ? &double_ar[0] : NULL), 
+                      lb_pointer, ub_pointer, 
+                      (num_ints > 0 ? &var_types[0] : NULL), NULL, NULL);
+        
+      } else {
+        //create a new model and immediately load in all the columns
+        if (num_ints == 0) {  
+          GRBnewmodel( env, &model, "scl", num_cols, &double_objective[0], lb_pointer, ub_pointer, NULL, NULL);
+        } else {
+          std::vector<char> var_types(num_cols);
+          for (int i=0; i<num_cols; ++i) {
+            var_types[i] = (col_type[i] == REAL ? GRB_CONTINUOUS : GRB_INTEGER);
+          }
+          GRBnewmodel( env, &model, "scl", num_cols, &double_objective[0], lb_pointer, ub_pointer, &var_types[0], NULL);
+        }
+      
+        //add the constraints (rows)  here we make them empty equality rows and fix the RHS
+        for (int i=0; i<num_rows; i++) {
+          switch (eq_type[i]) {
+            case EQ: 
+              GRBaddconstr( model, 0, NULL, NULL, GRB_EQUAL, double_RHS[i], NULL);
+              break;
+            case LE:
+              GRBaddconstr( model, 0, NULL, NULL, GRB_LESS_EQUAL, double_RHS[i], NULL);
+              break;
+            case GE:
+              GRBaddconstr( model, 0, NULL, NULL, GRB_GREATER_EQUAL, double_RHS[i], NULL);
+              break;
+          } 
+        }
+        GRBupdatemodel(model);
+      
+        //add the matrix:
+        GRBchgcoeffs( model, (int)ia.size(), &ia[0], &ja[0], &double_ar[0] );
+      }
+      
+      backend.prob = (void*)model;
+      backend.env = (void*)env;
+      backend.solver = solver;
       
-    
-    //create a new model and immediately load in all the columns
-    if (num_ints == 0) {  
-      GRBnewmodel( env, &model, "scl", num_cols, &double_objective[0], lb_pointer, ub_pointer, NULL, NULL);
     } else {
-      std::vector<char> var_types(num_cols);
-      for (int i=0; i<num_cols; ++i) {
-        var_types[i] = (col_type[i] == REAL ? GRB_CONTINUOUS : GRB_INTEGER);
+      //the model is still loaded from the last solve; gurobi keeps 
+      //the last basis, so we only push the changes and it warm starts
+      model = (GRBmodel*)backend.prob;
+      env = (GRBenv*)backend.env;
+      
+      for (int i=0; i<(int)backend.dirty_rows.size(); ++i) {
+        int r = backend.dirty_rows[i];
+        GRBsetdblattrelement(model, GRB_DBL_ATTR_RHS, r, double_RHS[r]);
+        GRBsetcharattrelement(model, GRB_CHAR_ATTR_SENSE, r, 
+                              (eq_type[r] == EQ ? GRB_EQUAL 
+                                                : (eq_type[r] == LE ? GRB_LESS_EQUAL 
+                                                                    : GRB_GREATER_EQUAL)));
       }
-      GRBnewmodel( env, &model, "scl", num_cols, &double_objective[0], lb_pointer, ub_pointer, &var_types[0], NULL);
-    }
-    
-    //add the constraints (rows)  here we make them empty equality rows and fix the RHS
-    for (int i=0; i<num_rows; i++) {
-      switch (eq_type[i]) {
-        case EQ: 
-          GRBaddconstr( model, 0, NULL, NULL, GRB_EQUAL, double_RHS[i], NULL);
-          break;
-        case LE:
-          GRBaddconstr( model, 0, NULL, NULL, GRB_LESS_EQUAL, double_RHS[i], NULL);
-          break;
-        case GE:
-          GRBaddconstr( model, 0, NULL, NULL, GRB_GREATER_EQUAL, double_RHS[i], NULL);
-          break;
-      } 
+      for (int i=0; i<(int)backend.dirty_cols.size(); ++i) {
+        int c = backend.dirty_cols[i];
+        GRBsetdblattrelement(model, GRB_DBL_ATTR_OBJ, c, double_objective[c]);
+        if ((int)col_bound_types.size() != 0) {
+          GRBsetdblattrelement(model, GRB_DBL_ATTR_LB, c, 
+                               (col_bound_types[c]  == UB || col_bound_types[c] == FREE ? -GRB_INFINITY : col_bounds_double[c]));
+          GRBsetdblattrelement(model, GRB_DBL_ATTR_UB, c, 
+                               (col_bound_types[c]  == LB || col_bound_types[c] == FREE ? GRB_INFINITY : col_bounds_double[c]));
+        }
+        if (num_ints > 0) {
+          GRBsetcharattrelement(model, GRB_CHAR_ATTR_VTYPE, c, 
+                                (col_type[c] == REAL ? GRB_CONTINUOUS : GRB_INTEGER));
+        }
+      }
+      
+      //coefficients which went away are set to 0, which deletes them
+      std::vector<int> rows;
+      std::vector<std::vector<int> > row_cols;
+      std::vector<std::vector<double> > row_vals;
+      get_changed_rows(rows, row_cols, row_vals);
+      std::vector<int> cind(0);
+      std::vector<int> vind(0);
+      std::vector<double> vals(0);
+      for (int i=0; i<(int)rows.size(); ++i) {
+        for (int j=0; j<(int)row_cols[i].size(); ++j) {
+          cind.push_back(rows[i]);
+          vind.push_back(row_cols[i][j]);
+          vals.push_back(row_vals[i][j]);
+        }
+      }
+      if ((int)vals.size() > 0) {
+        GRBchgcoeffs( model, (int)vals.size(), &cind[0], &vind[0], &vals[0] );
+      }
+      GRBupdatemodel(model);
     }
-    GRBupdatemodel(model);
     
-    //add the matrix:
-    GRBchgcoeffs( model, (int)ia.size(), &ia[0], &ja[0], &double_ar[0] );
+    backend.num_loaded_entries = ia.size();
+    backend.stale_ia.resize(0);
+    backend.stale_ja.resize(0);
+    backend.dirty_rows.resize(0);
+    backend.dirty_cols.resize(0);
     
     //set the correct optimization method
     if (solver == GUROBI_SIMPLEX) {
@@ -788,6 +1708,13 @@ SparseLPSolveCode SparseLP::solve(int verbose) {
     
     //optimize
     GRBoptimize( model );
+    if (STATS::enabled()) {
+      double iterations = 0;
+      int barrier_iterations = 0;
+      GRBgetdblattr(model, GRB_DBL_ATTR_ITERCOUNT, &iterations);
+      GRBgetintattr(model, GRB_INT_ATTR_BARITERCOUNT, &barrier_iterations);
+      STATS::add("lp_iterations", (long)iterations + barrier_iterations);
+    }
     
     //determine if the problem had a solution
     int problem_status;
@@ -795,19 +1722,13 @@ SparseLPSolveCode SparseLP::solve(int verbose) {
     if (problem_status != GRB_OPTIMAL) {
       if (problem_status == GRB_TIME_LIMIT) {
         std::cout << "Time limit\n";
-        GRBfreemodel(model);
-        GRBfreeenv(env);
         return LP_TIME_LIMIT;
       } else if (problem_status != GRB_INF_OR_UNBD && 
                  problem_status != GRB_INFEASIBLE &&
                  problem_status != GRB_UNBOUNDED) {
         std::cout << "Gurobi Linear programming error\n";
-        GRBfreemodel(model);
-        GRBfreeenv(env);
         return LP_ERROR;
       } else {
-        GRBfreemodel(model);
-        GRBfreeenv(env);
         return LP_INFEASIBLE;
       }
     }
@@ -821,6 +1742,11 @@ SparseLPSolveCode SparseLP::solve(int verbose) {
     double_soln_vector.resize(num_cols);
     GRBgetdblattrarray( model, GRB_DBL_ATTR_X, 0, num_cols, &double_soln_vector[0] );
     
+    if (num_ints == 0) {
+      double_dual_vector.resize(num_rows);
+      GRBgetdblattrarray( model, GRB_DBL_ATTR_PI, 0, num_rows, &double_dual_vector[0] );
+    }
+    
     if (verbose > 2) {
       std::cout << "got lp solution vector: " << "\n";
       for (int i=0; i<num_cols; ++i) {
@@ -829,9 +1755,6 @@ SparseLPSolveCode SparseLP::solve(int verbose) {
       std::cout << "\n";
     }
     
-    //free stuff
-    GRBfreemodel(model);
-    GRBfreeenv(env);
 #endif
   }
   
@@ -842,7 +1765,7 @@ SparseLPSolveCode SparseLP::solve(int verbose) {
 
 
 void SparseLP::print_LP() {
-  if (solver != EXLP) {
+  if (!exact_storage(solver)) {
     std::cout << "Cols: " << num_cols << "\n";
     std::cout << "Rows: " << num_rows << "\n";
     std::cout << "Objective: ";
@@ -861,6 +1784,14 @@ void SparseLP::print_LP() {
       }
     }
     std::cout << "\nEntries: ";
+    if (by_columns) {
+      for (int j=0; j<(int)col_start.size(); ++j) {
+        int end = (j+1 < (int)col_start.size() ? col_start[j+1] : (int)row_index.size());
+        for (int k=col_start[j]; k<end; ++k) {
+          std::cout << "(" << row_index[k] << "," << j << "," << double_ar[k] << "), ";
+        }
+      }
+    }
     for (int i=0; i<(int)ia.size(); ++i) {
       std::cout << "(" << ia[i] << "," << ja[i] << "," << double_ar[i] << "), ";
     }
@@ -878,6 +1809,14 @@ void SparseLP::print_LP() {
       std::cout << RHS[i] << " ";
     }
     std::cout << "\nEntries: ";
+    if (by_columns) {
+      for (int j=0; j<(int)col_start.size(); ++j) {
+        int end = (j+1 < (int)col_start.size() ? col_start[j+1] : (int)row_index.size());
+        for (int k=col_start[j]; k<end; ++k) {
+          std::cout << "(" << row_index[k] << "," << j << "," << ar[k] << "), ";
+        }
+      }
+    }
     for (int i=0; i<(int)ia.size(); ++i) {
       std::cout << "(" << ia[i] << "," << ja[i] << "," << ar[i] << "), ";
     }
@@ -3,6 +3,8 @@
 
 #include <vector>
 #include <string>
+#include <algorithm>
+#include <climits>
 #include "rational.h"
 
 enum SparseLPEqualityType {EQ, LE, GE};
@@ -17,10 +19,80 @@ enum SparseLPSolver {GLPK,
                       GUROBI, 
                       GUROBI_SIMPLEX, 
                       GUROBI_IPT, 
-                      EXLP};
+                      EXLP,
+                      GLPK_EXACT};
 
 enum SparseLPSolveCode {LP_OPTIMAL, LP_INFEASIBLE, LP_ERROR, LP_TIME_LIMIT};
 
+//the solver's own copy of the problem, which is kept alive between calls 
+//to SparseLP::solve, so that a re-solve only has to push the rows, 
+//columns, and entries which changed, and can start from the last basis
+//(copying a SparseLPBackend gives an empty one)
+struct SparseLPBackend {
+  SparseLPSolver solver;
+  void* prob;                     //glp_prob* or GRBmodel*
+  void* env;                      //GRBenv* (gurobi only)
+  int num_loaded_entries;         //entries [0,num_loaded_entries) are loaded
+  std::vector<int> stale_ia;      //loaded entries which have since been removed
+  std::vector<int> stale_ja;
+  std::vector<int> dirty_rows;    //rows whose RHS or type changed
+  std::vector<int> dirty_cols;    //cols whose objective, bound, or type changed
+  
+  SparseLPBackend();
+  SparseLPBackend(const SparseLPBackend& other);
+  SparseLPBackend& operator=(const SparseLPBackend& other);
+  ~SparseLPBackend();
+  void clear();
+  bool is_loaded(SparseLPSolver s);
+};
+
+//merges the entries of a column which are in the same row, in time linear 
+//in the number of entries.  A row has already been seen in this column 
+//iff its mark is the current generation, so the dense arrays (indexed by 
+//row) are never cleared between columns.  After merge, the k-th merged 
+//row is the row of entry first[k], which is its first nonzero entry, and 
+//sum[k] is the sum of its entries; rows whose entries are all 0 are left out
+template <typename T>
+class SparseAccumulator {
+  std::vector<int> mark;
+  std::vector<int> position;
+  int generation;
+  
+public:
+  std::vector<int> first;
+  std::vector<T> sum;
+  
+  SparseAccumulator() : generation(0) {}
+  
+  void merge(const std::vector<int>& temp_ia, const std::vector<T>& temp_ar) {
+    first.resize(0);
+    sum.resize(0);
+    if (generation == INT_MAX) {
+      std::fill(mark.begin(), mark.end(), 0);
+      generation = 0;
+    }
+    generation++;
+    for (int j=0; j<(int)temp_ia.size(); j++) {
+      if (temp_ar[j] == 0) {
+        continue;
+      }
+      int r = temp_ia[j];
+      if (r >= (int)mark.size()) {
+        mark.resize(r+1, 0);
+        position.resize(r+1);
+      }
+      if (mark[r] == generation) {
+        sum[position[r]] += temp_ar[j];
+      } else {
+        mark[r] = generation;
+        position[r] = (int)first.size();
+        first.push_back(j);
+        sum.push_back(temp_ar[j]);
+      }
+    }
+  }
+};
+
 class SparseLP {
 
 private:
@@ -34,6 +106,8 @@ private:
   std::vector<double> double_RHS;
   std::vector<Rational> soln_vector;
   std::vector<double> double_soln_vector;
+  std::vector<Rational> dual_vector;          //empty unless the solver gave duals
+  std::vector<double> double_dual_vector;
   Rational op_val;
   double double_op_val;
   std::vector<SparseLPEqualityType> eq_type;
@@ -42,11 +116,32 @@ private:
   std::vector<SparseLPColumnBoundType> col_bound_types;
   std::vector<double> col_bounds_double;
   std::vector<int> col_bounds;
+  
+  //compressed column storage, used instead of ia and ja once begin_column 
+  //is called: column j is row_index[col_start[j]..col_start[j+1]), with 
+  //the values in ar or double_ar.  The last column is the one being filled
+  bool by_columns;
+  std::vector<int> col_start;
+  std::vector<int> row_index;
 
   int num_cols;
   int num_rows;
   
   SparseLPSolver solver;
+  
+  SparseLPBackend backend;
+  SparseAccumulator<int> accumulator;       //for extend_entries_no_dups
+  SparseAccumulator<double> double_accumulator;
+  void get_changed_rows(std::vector<int>& rows, 
+                        std::vector<std::vector<int> >& row_cols,
+                        std::vector<std::vector<double> >& row_vals);
+  void get_csc_entries(std::vector<int>& col_start, 
+                       std::vector<int>& row_index, 
+                       std::vector<int>& value);
+  void advance_column(int j);
+  bool push_index(int i, int j);
+  SparseLPSolveCode solve_exlp(int verbose);
+  SparseLPSolveCode solve_glpk_exact(int verbose);
 
 public:
   
@@ -59,6 +154,7 @@ public:
   void set_col_bound(int c, SparseLPColumnBoundType t);
   void set_col_bound(int c, SparseLPColumnBoundType t, double b);
   void set_col_bound(int c, SparseLPColumnBoundType t, int b);
+  void begin_column(int j);
   void add_entry(int i, int j, Rational& r);
   void add_entry(int i, int j, int a);
   void add_entry(int i, int j, double a);
@@ -79,6 +175,8 @@ public:
   void get_soln_vector(std::vector<double>& sv);
   void get_soln_vector(std::vector<long double>& sv);
   void get_soln_vector(std::vector<Rational>& sv);
+  void get_dual_vector(std::vector<double>& dv);
+  void get_dual_vector(std::vector<Rational>& dv);
   void get_optimal_value(double& ov);
   void get_optimal_value(Rational& ov);
   
@@ -88,4 +186,14 @@ public:
   
 };
 
+//for column generation: whether the solver's duals are exact, so that 
+//columns can be priced exactly.  Only HYBRID's are; EXLP gives no duals 
+//at all (so every column has to be added), and the others give doubles
+bool gives_exact_duals(SparseLPSolver s);
+
+//whether a reduced cost is negative; with doubles, by more than the 
+//solver's rounding
+bool is_negative(double d);
+bool is_negative(const Rational& d);
+
 #endif
\ No newline at end of file
@@ -1,6 +1,9 @@
 #include <vector>
 #include <iostream>
 #include <math.h>
+#include <string.h>
+#include <limits.h>
+#include <utility>
 
 #include "rational.h"
 
@@ -30,246 +33,528 @@ int lcm(int a, int b) {
 /******************************************************************************/
 /* member functions for the rational class                                    */
 /******************************************************************************/
+
+//overflow-checked arithmetic on the small representation; LONG_MIN is
+//excluded so that numerators can always be negated
+static inline bool mul_ok(long a, long b, long& c) {
+  return !__builtin_mul_overflow(a, b, &c) && c != LONG_MIN;
+}
+
+static inline bool add_ok(long a, long b, long& c) {
+  return !__builtin_add_overflow(a, b, &c) && c != LONG_MIN;
+}
+
+static inline bool sub_ok(long a, long b, long& c) {
+  return !__builtin_sub_overflow(a, b, &c) && c != LONG_MIN;
+}
+
+//a, b >= 0
+static inline long gcd_l(long a, long b) {
+  long t;
+  while (b != 0) {
+    t = a % b;
+    a = b;
+    b = t;
+  }
+  return a;
+}
+
+static inline long abs_l(long a) {
+  return (a < 0 ? -a : a);
+}
+
+void Rational::set_small(long n, long d) {
+  if (big) {
+    mpq_clear(R);
+    big = 0;
+  }
+  num = n;
+  den = d;
+}
+
+//set from q, going back to the small representation if it fits
+void Rational::set_mpq(mpq_t q) {
+  if (mpz_fits_slong_p(mpq_numref(q)) && mpz_fits_slong_p(mpq_denref(q))) {
+    long n = mpz_get_si(mpq_numref(q));
+    long d = mpz_get_si(mpq_denref(q));
+    if (n != LONG_MIN && d != LONG_MIN && d != 0) {
+      if (d < 0) {
+        n = -n;
+        d = -d;
+      }
+      long g = gcd_l(abs_l(n), d);
+      set_small(n/g, d/g);
+      return;
+    }
+  }
+  if (!big) {
+    mpq_init(R);
+    big = 1;
+  }
+  mpq_set(R, q);
+}
+
+//q must already be initialized
+void Rational::to_mpq(mpq_t q) const {
+  if (big) {
+    mpq_set(q, R);
+  } else {
+    mpq_set_si(q, num, den);
+  }
+}
+
+void Rational::set_sum(const Rational& a, const Rational& b) {
+  if (!a.big && !b.big) {
+    long g = gcd_l(a.den, b.den);
+    long t1, t2, t, d;
+    if (mul_ok(a.num, b.den/g, t1) && mul_ok(b.num, a.den/g, t2) && add_ok(t1, t2, t)) {
+      if (t == 0) {
+        set_small(0, 1);
+        return;
+      }
+      long g2 = gcd_l(abs_l(t), g);
+      if (mul_ok(a.den/g, b.den/g2, d)) {
+        set_small(t/g2, d);
+        return;
+      }
+    }
+  }
+  gmp_op(mpq_add, a, b);
+}
+
+void Rational::set_difference(const Rational& a, const Rational& b) {
+  if (!a.big && !b.big) {
+    long g = gcd_l(a.den, b.den);
+    long t1, t2, t, d;
+    if (mul_ok(a.num, b.den/g, t1) && mul_ok(b.num, a.den/g, t2) && sub_ok(t1, t2, t)) {
+      if (t == 0) {
+        set_small(0, 1);
+        return;
+      }
+      long g2 = gcd_l(abs_l(t), g);
+      if (mul_ok(a.den/g, b.den/g2, d)) {
+        set_small(t/g2, d);
+        return;
+      }
+    }
+  }
+  gmp_op(mpq_sub, a, b);
+}
+
+void Rational::set_product(const Rational& a, const Rational& b) {
+  if (!a.big && !b.big) {
+    if (a.num == 0 || b.num == 0) {
+      set_small(0, 1);
+      return;
+    }
+    long g1 = gcd_l(abs_l(a.num), b.den);
+    long g2 = gcd_l(abs_l(b.num), a.den);
+    long n, d;
+    if (mul_ok(a.num/g1, b.num/g2, n) && mul_ok(a.den/g2, b.den/g1, d)) {
+      set_small(n, d);
+      return;
+    }
+  }
+  gmp_op(mpq_mul, a, b);
+}
+
+void Rational::set_quotient(const Rational& a, const Rational& b) {
+  if (!b.big && b.num != 0) {
+    Rational inv;
+    inv.num = (b.num < 0 ? -b.den : b.den);
+    inv.den = abs_l(b.num);
+    set_product(a, inv);
+    return;
+  }
+  gmp_op(mpq_div, a, b);    //including division by zero, as it always was
+}
+
+//the fallback for the arithmetic above: only the small operands are
+//converted, and the answer is computed in place if this is already big
+void Rational::gmp_op(void (*op)(mpq_ptr, mpq_srcptr, mpq_srcptr),
+                      const Rational& a, const Rational& b) {
+  mpq_t x, y, z;
+  mpq_srcptr pa = a.R;
+  mpq_srcptr pb = b.R;
+  int convert_a = !a.big;    //a or b may be this, so remember these now
+  int convert_b = !b.big;
+  if (convert_a) {
+    mpq_init(x);
+    a.to_mpq(x);
+    pa = x;
+  }
+  if (convert_b) {
+    mpq_init(y);
+    b.to_mpq(y);
+    pb = y;
+  }
+  if (big) {
+    op(R, pa, pb);
+    set_mpq(R);
+  } else {
+    mpq_init(z);
+    op(z, pa, pb);
+    set_mpq(z);
+    mpq_clear(z);
+  }
+  if (convert_a) {
+    mpq_clear(x);
+  }
+  if (convert_b) {
+    mpq_clear(y);
+  }
+}
+
+int Rational::cmp(const Rational& a, const Rational& b) {
+  if (!a.big && !b.big) {
+    if (a.den == b.den) {
+      return (a.num < b.num ? -1 : (a.num > b.num ? 1 : 0));
+    }
+    long t1, t2;
+    if (mul_ok(a.num, b.den, t1) && mul_ok(b.num, a.den, t2)) {
+      return (t1 < t2 ? -1 : (t1 > t2 ? 1 : 0));
+    }
+  }
+  mpq_t x, y;
+  mpq_init(x);
+  mpq_init(y);
+  a.to_mpq(x);
+  b.to_mpq(y);
+  int c = mpq_cmp(x, y);
+  mpq_clear(x);
+  mpq_clear(y);
+  return c;
+}
+
 Rational::Rational() {
-  mpq_init(R);
-  inited = 1;
-  mpq_set_si(R,0,1);
+  num = 0;
+  den = 1;
+  big = 0;
 }
 
 Rational::Rational(int r) {
-  mpq_init(R);
-  inited = 1;
-  mpq_set_si(R,r,1);
+  num = r;
+  den = 1;
+  big = 0;
 }  
 
 Rational::Rational(int a, int b) {
-  mpq_init(R);
-  inited = 1;
-  mpq_set_si(R, a,b);
+  long n = a;
+  long d = b;
+  if (d < 0) {
+    n = -n;
+    d = -d;
+  }
+  long g = gcd_l(abs_l(n), d);
+  if (g > 1) {
+    n /= g;
+    d /= g;
+  }
+  num = n;
+  den = d;
+  big = 0;
 }
 
 Rational::Rational(mpq_t q) {
-  mpq_init(R);
-  inited = 1;
-  mpq_set(R, q);
+  big = 0;
+  set_mpq(q);
 }
 
 Rational::Rational(const Rational& other) {
-  mpq_init(R);
-  mpq_set(R, other.R);
+  num = other.num;
+  den = other.den;
+  big = other.big;
+  if (big) {
+    mpq_init(R);
+    mpq_set(R, other.R);
+  }
+}
+
+//only a big value has anything to steal; it leaves 0 behind
+Rational::Rational(Rational&& other) noexcept {
+  num = other.num;
+  den = other.den;
+  big = other.big;
+  if (big) {
+    R[0] = other.R[0];
+    other.big = 0;
+    other.num = 0;
+    other.den = 1;
+  }
 }
 
 Rational& Rational::operator=(const Rational& rhs) {
   if (this == &rhs) {
     return *this;
   }
-  mpq_set(R, rhs.R);
+  if (rhs.big) {
+    if (!big) {
+      mpq_init(R);
+      big = 1;
+    }
+    mpq_set(R, rhs.R);
+  } else {
+    set_small(rhs.num, rhs.den);
+  }
+  return *this;
+}
+
+Rational& Rational::operator=(Rational&& rhs) noexcept {
+  if (this == &rhs) {
+    return *this;
+  }
+  if (rhs.big) {
+    if (big) {
+      mpq_swap(R, rhs.R);
+    } else {
+      R[0] = rhs.R[0];
+      big = 1;
+      rhs.big = 0;
+      rhs.num = 0;
+      rhs.den = 1;
+    }
+  } else {
+    set_small(rhs.num, rhs.den);
+  }
   return *this;
 }
 
 Rational::~Rational() {
-  mpq_clear(R);
+  if (big) {
+    mpq_clear(R);
+  }
 }
 
 void Rational::get_mpq(mpq_t q) {
-  mpq_set(q,R);
+  to_mpq(q);
 }
 
-double Rational::get_d() {
-  return mpq_get_d(R);
+double Rational::get_d() const {
+  if (big) {
+    return mpq_get_d(R);
+  }
+  return (double)num / (double)den;
 }
 
 void Rational::canonicalize() {
-  mpq_canonicalize(R);
+  //small values are always canonical
+  if (big) {
+    mpq_canonicalize(R);
+  }
 }
 
-int Rational::d() {
-  return mpz_get_si(mpq_denref(R));;
+int Rational::d() const {
+  return (big ? mpz_get_si(mpq_denref(R)) : den);
 }
 
-int Rational::n() {
-  return mpz_get_si(mpq_numref(R));;
+int Rational::n() const {
+  return (big ? mpz_get_si(mpq_numref(R)) : num);
 }
 
-Rational Rational::add(const Rational& other) {
-  mpq_t temp;
-  mpq_init(temp);
-  mpq_add(temp, R, other.R);
-  Rational r = Rational(temp);
-  mpq_clear(temp);
+Rational Rational::add(const Rational& other) const {
+  Rational r;
+  r.set_sum(*this, other);
   return r;
 }
     
     
-Rational Rational::div(const Rational& other) {
-  mpq_t temp;
-  mpq_init(temp);
-  mpq_div(temp, R, other.R);
-  Rational r = Rational(temp);
-  mpq_clear(temp);
+Rational Rational::div(const Rational& other) const {
+  Rational r;
+  r.set_quotient(*this, other);
   return r;
 }
 
-Rational Rational::operator+(const Rational& other) {
-  mpq_t temp;
-  mpq_init(temp);
-  mpq_add(temp, R, other.R);
-  Rational r = Rational(temp);
-  mpq_clear(temp);
+Rational Rational::operator+(const Rational& other) const & {
+  Rational r;
+  r.set_sum(*this, other);
   return r;
 }
 
-Rational Rational::operator+(int other) {
-  mpq_t temp;
-  mpq_init(temp);
-  mpq_set_si(temp, other, 1);
-  mpq_add(temp, R, temp);
-  Rational r = Rational(temp);
-  mpq_clear(temp);
+Rational Rational::operator+(const Rational& other) && {
+  set_sum(*this, other);
+  return std::move(*this);
+}
+
+Rational Rational::operator+(int other) const {
+  Rational r;
+  r.set_sum(*this, Rational(other));
   return r;
 }
 
-Rational Rational::operator-(const Rational& other){
-  mpq_t temp;
-  mpq_init(temp);
-  mpq_sub(temp, R, other.R);
-  Rational r = Rational(temp);
-  mpq_clear(temp);
+Rational Rational::operator-(const Rational& other) const & {
+  Rational r;
+  r.set_difference(*this, other);
   return r;
 }
 
-Rational Rational::operator-(int other){
-  mpq_t temp;
-  mpq_init(temp);
-  mpq_set_si(temp, other, 1);
-  mpq_sub(temp, R, temp);
-  Rational r = Rational(temp);
-  mpq_clear(temp);
+Rational Rational::operator-(const Rational& other) && {
+  set_difference(*this, other);
+  return std::move(*this);
+}
+
+Rational Rational::operator-(int other) const {
+  Rational r;
+  r.set_difference(*this, Rational(other));
   return r;
 }
 
-Rational Rational::operator-(){
-  mpq_t temp;
-  mpq_init(temp);
-  mpq_neg(temp, R);
-  Rational r = Rational(temp);
-  mpq_clear(temp);
+Rational Rational::operator-() const & {
+  Rational r(*this);
+  r.negate();
   return r;
 }
 
+Rational Rational::operator-() && {
+  negate();
+  return std::move(*this);
+}
+
 
-Rational Rational::operator/(const Rational& other) {
-  mpq_t temp;
-  mpq_init(temp);
-  mpq_div(temp, R, other.R);
-  Rational r = Rational(temp);
-  mpq_clear(temp);
+Rational Rational::operator/(const Rational& other) const & {
+  Rational r;
+  r.set_quotient(*this, other);
   return r;
 }
 
-Rational Rational::operator/(int other) {
-  mpq_t temp;
-  mpq_init(temp);
-  mpq_set_si(temp, other, 1);
-  mpq_div(temp, R, temp);
-  Rational r = Rational(temp);
-  mpq_clear(temp);
+Rational Rational::operator/(const Rational& other) && {
+  set_quotient(*this, other);
+  return std::move(*this);
+}
+
+Rational Rational::operator/(int other) const {
+  Rational r;
+  r.set_quotient(*this, Rational(other));
   return r;
 }
 
-Rational Rational::operator*(const Rational& other) {
-  mpq_t temp;
-  mpq_init(temp);
-  mpq_mul(temp, R, other.R);
-  Rational r = Rational(temp);
-  mpq_clear(temp);
+Rational Rational::operator*(const Rational& other) const & {
+  Rational r;
+  r.set_product(*this, other);
   return r;
 }
 
-Rational Rational::operator*(int other) {
-  mpq_t temp;
-  mpq_init(temp);
-  mpq_set_si(temp, other, 1);
-  mpq_mul(temp, R, temp);
-  Rational r = Rational(temp);
-  mpq_clear(temp);
+Rational Rational::operator*(const Rational& other) && {
+  set_product(*this, other);
+  return std::move(*this);
+}
+
+Rational Rational::operator*(int other) const {
+  Rational r;
+  r.set_product(*this, Rational(other));
   return r;
 }
 
 
 Rational& Rational::operator+=(const Rational& other) {
-  mpq_add(R, R, other.R);
+  set_sum(*this, other);
   return *this;
 }
 
 Rational& Rational::operator+=(int other) {
-  mpq_t temp;
-  mpq_init(temp);
-  mpq_set_si(temp, other, 1);
-  mpq_add(R, R, temp);
-  mpq_clear(temp);
+  set_sum(*this, Rational(other));
+  return *this;
+}
+
+Rational& Rational::operator-=(const Rational& other) {
+  set_difference(*this, other);
+  return *this;
+}
+
+Rational& Rational::operator-=(int other) {
+  set_difference(*this, Rational(other));
   return *this;
 }
 
 Rational& Rational::operator*=(const Rational& other) {
-  mpq_mul(R, R, other.R);
+  set_product(*this, other);
   return *this;
 }
 
 Rational& Rational::operator*=(int other) {
-  mpq_t temp;
-  mpq_init(temp);
-  mpq_set_si(temp, other, 1);
-  mpq_mul(R, R, temp);
-  mpq_clear(temp);
+  set_product(*this, Rational(other));
   return *this;
 }
 
 Rational& Rational::operator/=(const Rational& other) {
-  mpq_div(R, R, other.R);
+  set_quotient(*this, other);
   return *this;
 }
 
 Rational& Rational::operator/=(int other) {
-  mpq_t temp;
-  mpq_init(temp);
-  mpq_set_si(temp, other, 1);
-  mpq_div(R, R, temp);
-  mpq_clear(temp);
+  set_quotient(*this, Rational(other));
   return *this;
 }
 
+Rational& Rational::addmul(const Rational& a, const Rational& b) {
+  Rational t;
+  t.set_product(a, b);
+  set_sum(*this, t);
+  return *this;
+}
 
-bool Rational::operator<(const Rational& other) {
-  return (mpq_cmp(R, other.R) < 0);
+Rational& Rational::submul(const Rational& a, const Rational& b) {
+  Rational t;
+  t.set_product(a, b);
+  set_difference(*this, t);
+  return *this;
 }
 
-bool Rational::operator>(const Rational& other) {
-  return (mpq_cmp(R, other.R) > 0);
+Rational& Rational::negate() {
+  if (big) {
+    mpq_neg(R, R);
+  } else {
+    num = -num;
+  }
+  return *this;
 }
 
-bool Rational::operator<(int other) {
-  return (mpq_cmp_si(R, other, 1) < 0);
+
+bool Rational::operator<(const Rational& other) const {
+  return (cmp(*this, other) < 0);
 }
 
-bool Rational::operator>(int other) {
-  return (mpq_cmp_si(R, other, 1) > 0);
+bool Rational::operator>(const Rational& other) const {
+  return (cmp(*this, other) > 0);
 }
 
-bool Rational::operator==(const Rational& other) {
-  return (mpq_cmp(R, other.R)==0);
+bool Rational::operator<(int other) const {
+  return (cmp(*this, Rational(other)) < 0);
 }
 
-bool Rational::operator==(int other) {
-  return (mpq_cmp_si(R, other, 1)==0);
+bool Rational::operator>(int other) const {
+  return (cmp(*this, Rational(other)) > 0);
 }
 
+bool Rational::operator==(const Rational& other) const {
+  if (!big && !other.big) {
+    return (num == other.num && den == other.den);
+  }
+  return (cmp(*this, other)==0);
+}
 
-ostream& operator<<(ostream& os, Rational r) {
-  if (mpz_cmp_si(mpq_denref(r.R), 1) == 0) {
-    os << mpz_get_si(mpq_numref(r.R));
-  } else { 
-    os << mpz_get_si(mpq_numref(r.R)) << "/" << mpz_get_si(mpq_denref(r.R));
+bool Rational::operator==(int other) const {
+  if (!big) {
+    return (den == 1 && num == other);
+  }
+  return (cmp(*this, Rational(other))==0);
+}
+
+
+ostream& operator<<(ostream& os, const Rational& r) {
+  if (!r.big) {
+    if (r.den == 1) {
+      os << r.num;
+    } else {
+      os << r.num << "/" << r.den;
+    }
+  } else {
+    //a big value needn't fit in a long, so let gmp write all the digits
+    //(as "num" or "num/den", the same as the small form)
+    char* str = mpq_get_str(NULL, 10, r.R);
+    os << str;
+    void (*gmp_free)(void*, size_t);
+    mp_get_memory_functions(NULL, NULL, &gmp_free);
+    gmp_free(str, strlen(str)+1);
   }
   return os;
 }
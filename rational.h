@@ -7,50 +7,78 @@
 
 /******************************************************************************/
 /** rational class  hiding gmp                                                */
+/** almost every value is a small fraction, so it is stored as a pair of      */
+/** longs, and only moves to a gmp mpq_t if some arithmetic would overflow    */
 /******************************************************************************/
 class Rational {
   private:
-    int inited;
+    long num;    //the value is num/den, in lowest terms with den > 0,
+    long den;    //unless big is set, in which case it is R
+    int big;     //(num is never LONG_MIN, so it can always be negated)
     mpq_t R;
+    void set_small(long n, long d);
+    void set_mpq(mpq_t q);
+    void to_mpq(mpq_t q) const;
+    void set_sum(const Rational& a, const Rational& b);
+    void set_difference(const Rational& a, const Rational& b);
+    void set_product(const Rational& a, const Rational& b);
+    void set_quotient(const Rational& a, const Rational& b);
+    void gmp_op(void (*op)(mpq_ptr, mpq_srcptr, mpq_srcptr),
+                const Rational& a, const Rational& b);
+    static int cmp(const Rational& a, const Rational& b);
   public:
     Rational();
     Rational(int r);
     Rational(int a, int b);
     Rational(mpq_t q);
     Rational(const Rational& other);
+    Rational(Rational&& other) noexcept;
     Rational& operator=(const Rational& rhs);
+    Rational& operator=(Rational&& rhs) noexcept;
     ~Rational();
     void get_mpq(mpq_t q);
-    double get_d();    
+    double get_d() const;
     void canonicalize();
-    int d();
-    int n();
-    Rational add(const Rational& other);
-    Rational div(const Rational& other);
-    Rational operator+(const Rational& other);
-    Rational operator+(int other);
-    Rational operator-(const Rational& other);
-    Rational operator-(int other);
-    Rational operator-();
-    Rational operator/(const Rational& other);
-    Rational operator/(int other);
-    Rational operator*(const Rational& other);
-    Rational operator*(int other);
+    int d() const;
+    int n() const;
+    Rational add(const Rational& other) const;
+    Rational div(const Rational& other) const;
+    //the && versions reuse a temporary left hand side for the answer,
+    //so a chain like a*b + c*d - e makes no more temporaries than it must
+    Rational operator+(const Rational& other) const &;
+    Rational operator+(const Rational& other) &&;
+    Rational operator+(int other) const;
+    Rational operator-(const Rational& other) const &;
+    Rational operator-(const Rational& other) &&;
+    Rational operator-(int other) const;
+    Rational operator-() const &;
+    Rational operator-() &&;
+    Rational operator/(const Rational& other) const &;
+    Rational operator/(const Rational& other) &&;
+    Rational operator/(int other) const;
+    Rational operator*(const Rational& other) const &;
+    Rational operator*(const Rational& other) &&;
+    Rational operator*(int other) const;
     Rational& operator+=(const Rational& other);
     Rational& operator+=(int other);
+    Rational& operator-=(const Rational& other);
+    Rational& operator-=(int other);
     Rational& operator*=(const Rational& other);
     Rational& operator*=(int other);
     Rational& operator/=(const Rational& other);
     Rational& operator/=(int other);
-    bool operator<(const Rational& other);
-    bool operator>(const Rational& other);
-    bool operator<(int other);
-    bool operator>(int other);
-    bool operator==(const Rational& other);
-    bool operator==(int other);
+    Rational& addmul(const Rational& a, const Rational& b);   //this += a*b
+    Rational& submul(const Rational& a, const Rational& b);   //this -= a*b
+    Rational& negate();
+    bool operator<(const Rational& other) const;
+    bool operator>(const Rational& other) const;
+    bool operator<(int other) const;
+    bool operator>(int other) const;
+    bool operator==(const Rational& other) const;
+    bool operator==(int other) const;
     
     
-    friend std::ostream& operator<<(std::ostream& os, Rational r);
+    friend std::ostream& operator<<(std::ostream& os, const Rational& r);
 
 };
 
@@ -9,6 +9,7 @@
 #include "../rational.h"
 #include "../word.h"
 #include "../lp.h"
+#include "../stats.h"
 
 #include "scabble.h"
 
@@ -26,13 +27,9 @@ SCABBLE::Pt::Pt(int dim) {
   x.resize(dim);
 }
 
-SCABBLE::Pt::Pt(const SCABBLE::Pt& p) {
-  int dim = (int)p.x.size();
-  x.resize(dim);
-  for (int i=0; i<dim; ++i) {
-    x[i] = p.x[i];
-  }
-}
+SCABBLE::Pt::Pt(const SCABBLE::Pt& p) : x(p.x) {}
+
+SCABBLE::Pt::Pt(SCABBLE::Pt&& p) noexcept : x(std::move(p.x)) {}
 
 SCABBLE::Pt::Pt(int dim, Rational& init) {
   x.resize(dim);
@@ -48,6 +45,16 @@ SCABBLE::Pt::Pt(int dim, int init) {
   }
 }
 
+SCABBLE::Pt& SCABBLE::Pt::operator=(const SCABBLE::Pt& p) {
+  x = p.x;
+  return *this;
+}
+
+SCABBLE::Pt& SCABBLE::Pt::operator=(SCABBLE::Pt&& p) noexcept {
+  x = std::move(p.x);
+  return *this;
+}
+
 int SCABBLE::Pt::dim() {
   return (int)x.size();
 }
@@ -57,37 +64,47 @@ Rational& SCABBLE::Pt::operator[](int i) {
 }
 
 SCABBLE::Pt SCABBLE::Pt::operator-(const SCABBLE::Pt& other) {
+  SCABBLE::Pt p(*this);
+  p -= other;
+  return p;
+}
+
+SCABBLE::Pt SCABBLE::Pt::operator+(const SCABBLE::Pt& other) {
+  SCABBLE::Pt p(*this);
+  p += other;
+  return p;
+}
+
+SCABBLE::Pt SCABBLE::Pt::operator-() {
+  SCABBLE::Pt p(*this);
   int dim = (int)x.size();
-  SCABBLE::Pt p(dim);
   for (int i=0; i<dim; ++i) {
-    p[i] = x[i] - other.x[i];
+    p.x[i].negate();
   }
   return p;
 }
 
-SCABBLE::Pt SCABBLE::Pt::operator+(const SCABBLE::Pt& other) {
+SCABBLE::Pt& SCABBLE::Pt::operator-=(const SCABBLE::Pt& other) {
   int dim = (int)x.size();
-  SCABBLE::Pt p(dim);
   for (int i=0; i<dim; ++i) {
-    p[i] = x[i] + other.x[i];
+    x[i] -= other.x[i];
   }
-  return p;
+  return *this;
 }
 
-SCABBLE::Pt SCABBLE::Pt::operator-() {
+SCABBLE::Pt& SCABBLE::Pt::operator+=(const SCABBLE::Pt& other) {
   int dim = (int)x.size();
-  SCABBLE::Pt p(dim);
   for (int i=0; i<dim; ++i) {
-    p[i] = -x[i];
+    x[i] += other.x[i];
   }
-  return p;
+  return *this;
 }
 
 Rational SCABBLE::Pt::dot(const SCABBLE::Pt& other) {
   Rational r = 0;
   int dim = (int)x.size();
   for (int i=0; i<dim; ++i) {
-    r += (x[i] * other.x[i]);
+    r.addmul(x[i], other.x[i]);
   }
   return r;
 }
@@ -98,9 +115,9 @@ SCABBLE::Pt SCABBLE::Pt::cross(const SCABBLE::Pt& other) {
     return SCABBLE::Pt();
   }
   SCABBLE::Pt p(3);
-  p[0] = x[1]*other.x[2] - x[2]*other.x[1];
-  p[1] = x[2]*other.x[0] - x[0]*other.x[2];
-  p[2] = x[0]*other.x[1] - x[1]*other.x[0];
+  p[0].addmul(x[1], other.x[2]).submul(x[2], other.x[1]);
+  p[1].addmul(x[2], other.x[0]).submul(x[0], other.x[2]);
+  p[2].addmul(x[0], other.x[1]).submul(x[1], other.x[0]);
   return p;
 }
 
@@ -151,13 +168,11 @@ SCABBLE::Pt& SCABBLE::Pt::operator/=(int m) {
 
 //negate the coordinates which are masked in i
 SCABBLE::Pt SCABBLE::Pt::negate_coords(int i) {
+  SCABBLE::Pt p(*this);
   int dim = (int)x.size();
-  SCABBLE::Pt p(dim);
   for (int j=0; j<dim; ++j) {
     if ( ((i>>j)&1) == 1 ) {
-      p[j] = -x[j];
-    } else {
-      p[j] = x[j];
+      p.x[j].negate();
     }
   }
   return p;
@@ -183,28 +198,30 @@ std::ostream& operator<<(std::ostream& os, const SCABBLE::Pt& p) {
 
 
 //compute a normal and normal value 
+//(the normal is scaled to be integral, with an integral normal value)
 void SCABBLE::affine_hyperplane(std::vector<SCABBLE::Pt>& face, 
                                 SCABBLE::Pt& normal, 
                                 Rational& normal_value) {
   if ((int)face.size() == 2) {
-    SCABBLE::Pt parallel = face[1]-face[0];
-    normal[0] = -parallel[1];
-    normal[1] = parallel[0];
-    normal.rescale_to_integer();
-    normal_value = normal.dot(face[0]);
-    normal *= normal_value.d();
-    normal_value = normal.dot(face[0]);
+    normal[0] = face[0][1];
+    normal[0] -= face[1][1];
+    normal[1] = face[1][0];
+    normal[1] -= face[0][0];
   } else if ((int)face.size() == 3) {
-    SCABBLE::Pt parallel1 = face[1]-face[0];
-    SCABBLE::Pt parallel2 = face[2]-face[0];
+    SCABBLE::Pt parallel1(face[1]);
+    parallel1 -= face[0];
+    SCABBLE::Pt parallel2(face[2]);
+    parallel2 -= face[0];
     normal = parallel1.cross(parallel2);
-    normal.rescale_to_integer();
-    normal_value = normal.dot(face[0]);
-    normal *= normal_value.d();
-    normal_value = normal.dot(face[0]);
   } else {
    std::cout << "Not implemented\n"; 
+   return;
   } 
+  normal.rescale_to_integer();
+  normal_value = normal.dot(face[0]);
+  int m = normal_value.d();
+  normal *= m;
+  normal_value *= m;
 }
 
 
@@ -296,18 +313,8 @@ void SCABBLE::CyclicProduct::cyc_red(std::string &S) {
   int current_start;
   int ord;
   std::vector<std::pair<char, int> > chunks(0);
-  i=0;
   //reduce the interior of the word
-  while (i < (int)S.size()-1) {
-    if (S[i] == swapCaseChar(S[i+1])) {
-      S.erase(i,2);
-      if (i > 0) {
-        i--;
-      }
-    } else {
-      i++;
-    }
-  }
+  red(S);
   
   //std::cout << "after reducing interior:" << S << "\n";
   
@@ -590,8 +597,10 @@ std::ostream& SCABBLE::operator<<(std::ostream &os, Chain &C) {
  * the edge is the letter just before it, and the letter just after
  ****************************************************************************/
 SCABBLE::CentralEdgePairList::CentralEdgePairList() {
+  num_letters = 0;
   edge_pairs.resize(0);
   edge_pairs_beginning_with.resize(0);
+  index_table.resize(0);
 }
 
 SCABBLE::CentralEdgePairList::CentralEdgePairList(Chain &C) {
@@ -601,6 +610,7 @@ SCABBLE::CentralEdgePairList::CentralEdgePairList(Chain &C) {
   num_letters = C.num_letters();
   edge_pairs.resize(0);
   edge_pairs_beginning_with.resize(num_letters);
+  index_table = std::vector<int>(num_letters*num_letters, -1);
   for (i=0; i<num_letters; i++) {
     edge_pairs_beginning_with[i].resize(0);
     temp_central_edge_pair.first = i;
@@ -612,6 +622,7 @@ SCABBLE::CentralEdgePairList::CentralEdgePairList(Chain &C) {
       temp_central_edge_pair.last = j;
       edge_pairs.push_back(temp_central_edge_pair);
       edge_pairs_beginning_with[i].push_back(edge_pairs.size()-1);
+      index_table[i*num_letters + j] = edge_pairs.size()-1;
     }
   }
 }
@@ -621,24 +632,15 @@ SCABBLE::CentralEdgePairList::CentralEdgePairList(Chain &C) {
 //this returns ind+1
 //otherwise, it returns -(ind+1)
 int SCABBLE::CentralEdgePairList::get_index(int a, int b) {
-  int i;
   int bm1 = my_chain->prev_letter(b); // sub_1_mod(b, num_letters);
   int ap1 = my_chain->next_letter(a);
   //std::cout << "Getting index of " << a << ", " << b << "\n";
+  //a missing pair is -1 in the table, so it comes out as 0, which is bad
   if (bm1 > a) {
-    for (i=0; i<(int)edge_pairs_beginning_with[a].size(); i++) {
-      if (edge_pairs[edge_pairs_beginning_with[a][i]].last == b) {
-        return edge_pairs_beginning_with[a][i]+1;
-      }
-    }
+    return index_table[a*num_letters + b]+1;
   } else {
-    for (i=0; i<(int)edge_pairs_beginning_with[bm1].size(); i++) {
-      if (edge_pairs[edge_pairs_beginning_with[bm1][i]].last == ap1) {
-        return -(edge_pairs_beginning_with[bm1][i]+1);
-      }
-    }
+    return -(index_table[bm1*num_letters + ap1]+1);
   }
-  return 0;  //this is bad
 }
 
 SCABBLE::CentralEdgePair SCABBLE::CentralEdgePairList::operator[](int index) {
@@ -668,8 +670,10 @@ int SCABBLE::CentralEdgePairList::size() {
  * these are from the POLYGON's PERSPECTIVE
  ****************************************************************************/
 SCABBLE::InterfaceEdgeList::InterfaceEdgeList() {
+  num_letters = 0;
   edges.resize(0);
   edges_beginning_with.resize(0);
+  index_table.resize(0);
 }
 
 SCABBLE::InterfaceEdgeList::InterfaceEdgeList(Chain &C) {
@@ -677,8 +681,9 @@ SCABBLE::InterfaceEdgeList::InterfaceEdgeList(Chain &C) {
   int num_groups = (C.G)->num_groups();
   InterfaceEdge temp_interface_edge;
   
+  num_letters = C.num_letters();
   edges.resize(0);
-  edges_beginning_with.resize(C.num_letters());
+  edges_beginning_with.resize(num_letters);
   
   for (i=0; i<num_groups; i++) {
     
@@ -724,26 +729,24 @@ SCABBLE::InterfaceEdgeList::InterfaceEdgeList(Chain &C) {
       }
     }
   }
+  
+  //the edges are already listed by first letter, so we only need to 
+  //fill in the table from those lists
+  index_table = std::vector<int>(num_letters*num_letters, -1);
+  for (i=0; i<num_letters; i++) {
+    for (j=(int)edges_beginning_with[i].size()-1; j>=0; j--) {
+      k = edges_beginning_with[i][j];
+      index_table[i*num_letters + edges[k].last] = k;
+    }
+  }
 }
 
 int SCABBLE::InterfaceEdgeList::get_index_from_poly_side(int a, int b) {
-  int i;
-  for (i=0; i<(int)edges_beginning_with[a].size(); i++) {
-    if (edges[edges_beginning_with[a][i]].last == b) {
-      return edges_beginning_with[a][i];
-    }
-  }
-  return -1;
+  return index_table[a*num_letters + b];
 }
 
 int SCABBLE::InterfaceEdgeList::get_index_from_group_side(int a, int b) {
-  int i;
-  for (i=0; i<(int)edges_beginning_with[b].size(); i++) {
-    if (edges[edges_beginning_with[b][i]].last == a) {
-      return edges_beginning_with[b][i];
-    }
-  }
-  return -1;
+  return index_table[b*num_letters + a];
 }
 
 SCABBLE::InterfaceEdge SCABBLE::InterfaceEdgeList::operator[](int index) {
@@ -767,8 +770,12 @@ int SCABBLE::InterfaceEdgeList::size() {
 /*****************************************************************************
  Central polygons
  *****************************************************************************/
+bool SCABBLE::CentralPolygon::is_interface(int j) const {
+  return (interface >> j) & 1;
+}
+
 int SCABBLE::CentralPolygon::chi_times_2() {
-  return 2 - (int)edges.size();
+  return 2 - num_sides;
 }
 
 void SCABBLE::CentralPolygon::compute_ia_etc_for_edges(int col, 
@@ -777,12 +784,11 @@ void SCABBLE::CentralPolygon::compute_ia_etc_for_edges(int col,
                                               CentralEdgePairList &CEL,
                                               SparseLP& LP) {
   int i,j,row,val;
-  int num_sides = (int)edges.size();
   std::vector<int> temp_ia(0);
   std::vector<int> temp_ja(0);
   std::vector<int> temp_ar(0);
   for (j=0; j<num_sides; j++) {
-    if (interface[j]) {
+    if (is_interface(j)) {
       row = IEL.get_index_from_poly_side(edges[j].first, edges[j].second);
       val = 1;
     } else {
@@ -816,12 +822,12 @@ void SCABBLE::CentralPolygon::compute_ia_etc_for_edges(int col,
   
   
 
-std::ostream& SCABBLE::operator<<(std::ostream &os, CentralPolygon &CP) {
+std::ostream& SCABBLE::operator<<(std::ostream &os, const CentralPolygon &CP) {
   int j;
   os << "CP: ";
-  for (j=0; j<(int)CP.edges.size(); j++) {
+  for (j=0; j<CP.num_sides; j++) {
     os << "(" << CP.edges[j].first << ", " << CP.edges[j].second << ")";
-    if (CP.interface[j]) {
+    if (CP.is_interface(j)) {
       os << "i";
     } else {
       os << "c";
@@ -831,6 +837,46 @@ std::ostream& SCABBLE::operator<<(std::ostream &os, CentralPolygon &CP) {
   return os;
 }
 
+int SCABBLE::CentralPolygonList::size() const {
+  return (int)num_sides.size();
+}
+
+void SCABBLE::CentralPolygonList::clear() {
+  first.resize(0);
+  last.resize(0);
+  num_sides.resize(0);
+  interface.resize(0);
+}
+
+void SCABBLE::CentralPolygonList::reserve(int n) {
+  first.reserve(3*n);
+  last.reserve(3*n);
+  num_sides.reserve(n);
+  interface.reserve(n);
+}
+
+//unused sides of a bigon are stored as -1
+void SCABBLE::CentralPolygonList::push_back(const CentralPolygon &P) {
+  int j;
+  for (j=0; j<3; j++) {
+    first.push_back(j < P.num_sides ? P.edges[j].first : -1);
+    last.push_back(j < P.num_sides ? P.edges[j].second : -1);
+  }
+  num_sides.push_back((unsigned char)P.num_sides);
+  interface.push_back(P.interface);
+}
+
+SCABBLE::CentralPolygon SCABBLE::CentralPolygonList::operator[](int index) const {
+  int j;
+  CentralPolygon P;
+  P.num_sides = num_sides[index];
+  P.interface = interface[index];
+  for (j=0; j<3; j++) {
+    P.edges[j] = std::make_pair(first[3*index+j], last[3*index+j]);
+  }
+  return P;
+}
+
 
 /****************************************************************************
  group tooth
@@ -984,7 +1030,7 @@ std::ostream& SCABBLE::operator<<(std::ostream &os, GroupRectangle &GR) {
 }
 
 
-void SCABBLE::print_central_polys(std::vector<SCABBLE::CentralPolygon> &CP, 
+void SCABBLE::print_central_polys(SCABBLE::CentralPolygonList &CP, 
                          std::ostream &os, 
                          int level) {
   int i;
@@ -1133,18 +1179,18 @@ void SCABBLE::compute_group_teeth_and_rectangles(SCABBLE::Chain &C,
  *****************************************************************************/
 void SCABBLE::compute_central_polys(SCABBLE::Chain &C, 
                                     SCABBLE::InterfaceEdgeList &IEL, 
-                                    std::vector<SCABBLE::CentralPolygon> &CP) {
+                                    SCABBLE::CentralPolygonList &CP) {
   int i,j,k,l;
   int e1L1, e1L2, e2L1, e2L2, e3L1, e3L2;  //edge1, letter1, etc
   SCABBLE::CentralPolygon temp_central_poly;
   
-  CP.resize(0);
+  CP.clear();
   
   //first, enumerate all polys with two sides.  These are 
   //always both interface edges.  We may always assume that 
   //the smallest letter is at position 0
-  temp_central_poly.edges.resize(2);
-  temp_central_poly.interface = std::vector<bool>(2, true);
+  temp_central_poly.num_sides = 2;
+  temp_central_poly.interface = 0x3;
   for (i=0; i<(int)C.chain_letters.size(); i++) {               //the first letter
     e1L1 = i;
     for (j=0; j<(int)IEL.edges_beginning_with[i].size(); j++) { //which edge we are thinking about
@@ -1166,8 +1212,8 @@ void SCABBLE::compute_central_polys(SCABBLE::Chain &C,
   }
   
   //enumerate all polys with three sides, all interface
-  temp_central_poly.edges.resize(3);
-  temp_central_poly.interface = std::vector<bool>(3, true);
+  temp_central_poly.num_sides = 3;
+  temp_central_poly.interface = 0x7;
   for (i=0; i<(int)C.chain_letters.size(); i++) {               //the first letter
     e1L1 = i;
     for (j=0; j<(int)IEL.edges_beginning_with[i].size(); j++) { //which edge we are thinking about
@@ -1198,9 +1244,7 @@ void SCABBLE::compute_central_polys(SCABBLE::Chain &C,
   
   //enumerate all polys with three sides, 2 interface
   //we can no longer assume the first one is the smallest letter
-  temp_central_poly.edges.resize(3);
-  temp_central_poly.interface = std::vector<bool>(3, true);
-  temp_central_poly.interface[2] = false;
+  temp_central_poly.interface = 0x3;
   for (i=0; i<(int)C.chain_letters.size(); i++) {               //the first letter
     e1L1 = i;
     for (j=0; j<(int)IEL.edges_beginning_with[i].size(); j++) { //which edge we are thinking about
@@ -1225,9 +1269,7 @@ void SCABBLE::compute_central_polys(SCABBLE::Chain &C,
   
   //enumerate all polys with three sides, 1 interface
   //we can no longer assume the first one is the smallest letter
-  temp_central_poly.edges.resize(3);
-  temp_central_poly.interface = std::vector<bool>(3, false);
-  temp_central_poly.interface[0] = true;
+  temp_central_poly.interface = 0x1;
   for (i=0; i<(int)C.chain_letters.size(); i++) {               //the first letter
     e1L1 = i;
     for (j=0; j<(int)IEL.edges_beginning_with[i].size(); j++) { //which edge we are thinking about
@@ -1260,7 +1302,7 @@ void SCABBLE::init_orthant_lp(std::vector<std::pair<int, int> >& chain_locs,
                               SCABBLE::Chain& C, 
                               SCABBLE::InterfaceEdgeList& IEL, 
                               SCABBLE::CentralEdgePairList& CEL,
-                              std::vector<SCABBLE::CentralPolygon>& CP, 
+                              SCABBLE::CentralPolygonList& CP, 
                               std::vector<SCABBLE::GroupTooth>& GT, 
                               std::vector<SCABBLE::GroupRectangle>& GR,
                               SparseLP& LP,
@@ -1650,7 +1692,9 @@ void SCABBLE::point_scl(std::vector<std::vector<int> >& chain_cols,
     LP.print_LP();
   }
   
+  STATS::phase("solve");
   LP.solve(verbose);
+  STATS::phase("recovery");
   
   LP.get_optimal_value(scl);
   
@@ -1705,7 +1749,9 @@ void SCABBLE::face_scl(std::vector<std::vector<int> >& chain_cols,
     LP.print_LP();
   }
     
+  STATS::phase("solve");
   LP.solve(verbose);
+  STATS::phase("recovery");
   
   LP.get_optimal_value(scl);
   
@@ -1720,7 +1766,7 @@ void SCABBLE::face_scl(std::vector<std::vector<int> >& chain_cols,
     for (int j=0; j<(int)chain_cols[i].size(); ++j) {
       sum += soln_vector[chain_cols[i][j]];
     }
-    min_p[i] = sum;
+    min_p[i] = std::move(sum);
   }
   
   if (verbose > 2) {
@@ -1761,13 +1807,15 @@ void SCABBLE::compute_ball_ant(std::vector<std::pair<int, int> >& chain_locs,
   
   //now we build the rectangles and whatever for the *whole* chain
   //we'll restrict later
+  STATS::phase("edges");
   SCABBLE::InterfaceEdgeList IEL(C);
   if (verbose>3) IEL.print(std::cout);
   
   SCABBLE::CentralEdgePairList CEL(C);
   if (verbose>3) CEL.print(std::cout);
   
-  std::vector<SCABBLE::CentralPolygon> CP;
+  STATS::phase("polygons");
+  SCABBLE::CentralPolygonList CP;
   SCABBLE::compute_central_polys(C, IEL, CP);
   if (verbose > 3) {
     std::cout << "computed polys (" << CP.size() << ")\n"; std::cout.flush();
@@ -1782,6 +1830,7 @@ void SCABBLE::compute_ball_ant(std::vector<std::pair<int, int> >& chain_locs,
     SCABBLE::print_group_teeth_and_rectangles(GT, GR, std::cout, verbose);
   }
   
+  STATS::phase("lp_setup");
   SparseLP LP(solver);
   std::vector<std::vector<int> > chain_cols(0);
   std::vector<int> chain_rows(0);
@@ -1817,7 +1866,7 @@ void SCABBLE::compute_ball_ant(std::vector<std::pair<int, int> >& chain_locs,
   orthant_verts.resize(0);
   orthant_faces.resize(0);
   while (face_stack.size() > 0) {    
-    std::vector<SCABBLE::Pt> working_face = face_stack.back();
+    std::vector<SCABBLE::Pt> working_face = std::move(face_stack.back());
     face_stack.pop_back();
     
     if (verbose > 2) {
@@ -2081,7 +2130,7 @@ int SCABBLE::scabble(int argc, char** argv) {
   int current_arg = 0;
   
   if (argc < 1 || std::string(argv[0]) == "-h") {
-    std::cout << "usage: ./scallop -ball [-h] [-v[n]] [-P] [-m<GLPK,GIPT,EXLP,GUROBI>] <filename> [gen string] <chain1> , <chain2> , ...\n";
+    std::cout << "usage: ./scallop -ball [-h] [-v[n]] [-P] [-m<GLPK,GIPT,EXLP,HYBRID,GUROBI>] <filename> [gen string] <chain1> , <chain2> , ...\n";
     std::cout << "\twhere [gen string] is of the form <gen1><order1><gen2><order2>...\n";
     std::cout << "\te.g. a5b0 computes in Z/5Z * Z\n";
     std::cout << "\tand the <chain>s are integer linear combinations of words in the generators\n";
@@ -2091,7 +2140,7 @@ int SCABBLE::scabble(int argc, char** argv) {
     std::cout << "\t-h: print this message\n";
     std::cout << "\t-v[n]: verbose output (n=0,1,2,3); 0 gives quiet output\n";
     std::cout << "\t-P: output the polygon in CDD file format\n";
-    std::cout << "\t-m<format>: use the LP solver specified (EXLP uses GMP for exact output)\n";
+    std::cout << "\t-m<format>: use the LP solver specified (EXLP uses GMP for exact output; HYBRID solves with GLPK and then checks the answer exactly)\n";
     exit(0);
   }
   
@@ -2101,6 +2150,8 @@ int SCABBLE::scabble(int argc, char** argv) {
         solver = GLPK;
       } else if (argv[current_arg][2] == 'G' && argv[current_arg][3] == 'I') {
         solver = GLPK_IPT;
+      } else if (argv[current_arg][2] == 'H') {
+        solver = GLPK_EXACT;
       } else if (argv[current_arg][2] == 'G') {
         solver = GUROBI;
       } else if (argv[current_arg][2] == 'E') {
@@ -2189,6 +2240,7 @@ int SCABBLE::scabble(int argc, char** argv) {
                         solver, 
                         verbose);
   
+  STATS::phase("output");
   if (verbose > 1) {
     std::cout << "Writing ball output\n";
   }
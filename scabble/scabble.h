@@ -98,6 +98,7 @@ namespace SCABBLE {
     Chain* my_chain;;
     std::vector<CentralEdgePair> edge_pairs;
     std::vector<std::vector<int> > edge_pairs_beginning_with;
+    std::vector<int> index_table;     //index_table[a*num_letters+b] is the index of (a,b), or -1
   };
 
 
@@ -122,8 +123,10 @@ namespace SCABBLE {
     void print(std::ostream &os);
     int size();
     
+    int num_letters;
     std::vector<InterfaceEdge> edges;
     std::vector<std::vector<int> > edges_beginning_with;
+    std::vector<int> index_table;     //index_table[a*num_letters+b] is the index of (a,b), or -1
   };
 
 
@@ -132,8 +135,10 @@ namespace SCABBLE {
   * a central polygon  (this is a list of interface and polygon edges)
   * ***************************************************************************/
   struct CentralPolygon {
-    std::vector<std::pair<int, int> > edges; //these record the first and second letters in the edge pair
-    std::vector<bool> interface;   //this records whether the edge is an interface edge
+    int num_sides;                      //2 or 3
+    std::pair<int, int> edges[3];       //these record the first and second letters in the edge pair
+    unsigned char interface;            //bit j is set if edge j is an interface edge
+    bool is_interface(int j) const;
     int chi_times_2();
     void compute_ia_etc_for_edges(int col,
                                   Chain &C,
@@ -142,7 +147,26 @@ namespace SCABBLE {
                                   SparseLP& LP);
   };
 
-  std::ostream &operator<<(std::ostream &os, CentralPolygon &CP);
+  std::ostream &operator<<(std::ostream &os, const CentralPolygon &CP);
+
+  /*****************************************************************************
+  * all the central polygons, stored flat (there can be millions of them): 
+  * polygon i has num_sides[i] sides, side j is the edge 
+  * (first[3*i+j], last[3*i+j]), and it's an interface edge if bit j of 
+  * interface[i] is set.  operator[] unpacks a polygon
+  * ***************************************************************************/
+  struct CentralPolygonList {
+    int size() const;
+    void clear();
+    void reserve(int n);
+    void push_back(const CentralPolygon &P);
+    CentralPolygon operator[](int index) const;
+    
+    std::vector<int> first;
+    std::vector<int> last;
+    std::vector<unsigned char> num_sides;
+    std::vector<unsigned char> interface;
+  };
 
   /****************************************************************************
   * a group outside edge (these pair with the interface edges)
@@ -192,7 +216,7 @@ namespace SCABBLE {
    
 
     
-  void print_central_polys(std::vector<SCABBLE::CentralPolygon> &CP, 
+  void print_central_polys(SCABBLE::CentralPolygonList &CP, 
                          std::ostream &os, 
                          int level);
   
@@ -204,7 +228,7 @@ namespace SCABBLE {
   
   void compute_central_polys(SCABBLE::Chain &C, 
                              SCABBLE::InterfaceEdgeList &IEL, 
-                             std::vector<SCABBLE::CentralPolygon> &CP);
+                             SCABBLE::CentralPolygonList &CP);
   
   void compute_group_teeth_and_rectangles(SCABBLE::Chain &C, 
                                           std::vector<SCABBLE::GroupTooth > &GT,
@@ -220,13 +244,18 @@ namespace SCABBLE {
     Pt();
     Pt(int dim);
     Pt(const Pt& p);
+    Pt(Pt&& p) noexcept;
     Pt(int dim, Rational& init);
     Pt(int dim, int init);
+    Pt& operator=(const Pt& p);
+    Pt& operator=(Pt&& p) noexcept;
     int dim();
     Rational& operator[](int i);
     Pt operator-(const Pt& other);
     Pt operator+(const Pt& other);
     Pt operator-();
+    Pt& operator-=(const Pt& other);
+    Pt& operator+=(const Pt& other);
     Rational dot(const Pt& other);
     Pt cross(const Pt& other);
     void rescale_to_integer();
@@ -266,7 +295,7 @@ namespace SCABBLE {
                               SCABBLE::Chain& C, 
                               SCABBLE::InterfaceEdgeList& IEL, 
                               SCABBLE::CentralEdgePairList& CEL,
-                              std::vector<SCABBLE::CentralPolygon>& CP, 
+                              SCABBLE::CentralPolygonList& CP, 
                               std::vector<SCABBLE::GroupTooth>& GT, 
                               std::vector<SCABBLE::GroupRectangle>& GR,
                               SparseLP& LP,
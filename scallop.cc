@@ -1,21 +1,53 @@
 #include <iostream>
+#include <vector>
+#include <string>
+#include <stdlib.h>
 
 #include "scylla/scylla.h"
 #include "gallop/gallop.h"
 #include "trollop/trollop.h"
 #include "scabble/scabble.h"
 #include "hallop/hallop.h"
+#include "batch.h"
+#include "stats.h"
+#include "scl_cache.h"
 
-int main(int argc, char* argv[]) {
+//argv is everything after ./scallop
+static void scallop(int argc, char* argv[]) {
 
   enum {CYCLIC, LOCAL, TRAIN, BALL, HYP} comp_func;
   char** arg_array = NULL;
   int num_args;
   
-  if (argc < 2 || std::string(argv[1]) == "-h") {
+  //-T (or --stats) and --cache <file> can go anywhere, and are handled 
+  //here for every mode; the cache can also be given by $SCALLOP_CACHE
+  bool STATS_ON = false;
+  std::string cache_file = (getenv("SCALLOP_CACHE") != NULL ? getenv("SCALLOP_CACHE") : "");
+  std::vector<char*> args(0);
+  for (int i=0; i<argc; ++i) {
+    if (std::string(argv[i]) == "-T" || std::string(argv[i]) == "--stats") {
+      STATS_ON = true;
+    } else if (std::string(argv[i]) == "--cache" && i+1 < argc) {
+      cache_file = std::string(argv[i+1]);
+      ++i;
+    } else {
+      args.push_back(argv[i]);
+    }
+  }
+  SCLCACHE::use(cache_file);
+  argc = (int)args.size();
+  args.push_back(NULL);
+  argv = &args[0];
+  
+  if (argc < 1 || std::string(argv[0]) == "-h") {
     std::cout << "Scallop\n";
     std::cout << "Usage: ./scallop [-cyclic, -local, -train, -ball -hyp] <option-specific arguments>\n";
+    std::cout << "   or: ./scallop -batch [batch options] (run ./scallop -batch -h for info)\n";
     std::cout << "Enter ./scallop <option> -h (e.g. ./scallop -cyclic -h) for specific info\n";
+    std::cout << "Any mode takes -T (or --stats): print the time and memory used by each phase,\n";
+    std::cout << "\tand the size of the LP, as a line of JSON after the answer\n";
+    std::cout << "Any mode takes --cache <file> (or $SCALLOP_CACHE): look for the answer in the\n";
+    std::cout << "\tfile first, and add it there if it isn't (only -cyclic uses it so far)\n";
     std::cout << "\t-cyclic (default if no option is given):\n";
     std::cout << "\t\tCompute scl in free products of cyclic groups\n";
     std::cout << "\n";
@@ -30,37 +62,45 @@ int main(int argc, char* argv[]) {
     std::cout << "\n";
     std::cout << "\t-hyp:\n";
     std::cout << "\t\tCompute with relators (probably a surface group)\n";
-    return 0;
+    std::cout << "\n";
+    std::cout << "\t-batch:\n";
+    std::cout << "\t\tRead many of the above commands, one per line, and solve them in parallel\n";
+    return;
   }
   
-  if (argv[1][0] != '-') {
+  if (argv[0][0] != '-') {
     comp_func = LOCAL;
+    arg_array = &argv[0];
+    num_args = argc;
+  } else if (argv[0][1] == 't') {
+    comp_func = TRAIN;
     arg_array = &argv[1];
     num_args = argc-1;
-  } else if (argv[1][1] == 't') {
-    comp_func = TRAIN;
-    arg_array = &argv[2];
-    num_args = argc-2;
-  } else if (argv[1][1] == 'l') {
+  } else if (argv[0][1] == 'l') {
     comp_func = LOCAL;
-    arg_array = &argv[2];
-    num_args = argc-2;
-  } else if (argv[1][1] == 'c') {
+    arg_array = &argv[1];
+    num_args = argc-1;
+  } else if (argv[0][1] == 'c') {
     comp_func = CYCLIC;
-    arg_array = &argv[2];
-    num_args = argc-2;
-  } else if (argv[1][1] == 'b') {
+    arg_array = &argv[1];
+    num_args = argc-1;
+  } else if (argv[0][1] == 'b') {
     comp_func = BALL;
-    arg_array = &argv[2];
-    num_args = argc-2;
-  } else if (argv[1][1] == 'h') {
+    arg_array = &argv[1];
+    num_args = argc-1;
+  } else if (argv[0][1] == 'h') {
     comp_func = HYP;
-    arg_array = &argv[2];
-    num_args = argc-2;
-  } else {
-    comp_func = LOCAL;
     arg_array = &argv[1];
     num_args = argc-1;
+  } else {
+    comp_func = LOCAL;
+    arg_array = &argv[0];
+    num_args = argc;
+  }
+  
+  if (STATS_ON) {
+    STATS::start();
+    STATS::phase("parse");
   }
   
   switch (comp_func) {
@@ -81,6 +121,40 @@ int main(int argc, char* argv[]) {
       break;
   }
   
+  if (STATS_ON) {
+    STATS::stop();
+    STATS::print_json(std::cout);
+  }
+}
+
+//commands with the same (nonempty) key have the same scl, so -batch 
+//only solves one of them; so far only -cyclic commands get keys
+static std::string scallop_key(int argc, char* argv[]) {
+  if (argc < 1 || argv[0][0] != '-' || argv[0][1] != 'c') {
+    return "";
+  }
+  std::string cache = "";
+  std::vector<char*> args(0);
+  for (int i=1; i<argc; ++i) {
+    if (std::string(argv[i]) == "-T" || std::string(argv[i]) == "--stats") {
+      return "";
+    } else if (std::string(argv[i]) == "--cache" && i+1 < argc) {
+      cache = std::string("--cache ") + argv[i+1] + " ";
+      ++i;
+    } else {
+      args.push_back(argv[i]);
+    }
+  }
+  args.push_back(NULL);
+  std::string key = SCYLLA::canonical_command((int)args.size()-1, &args[0]);
+  return (key == "" ? key : "-cyclic " + cache + key);
+}
+
+int main(int argc, char* argv[]) {
+  if (argc > 1 && std::string(argv[1]) == "-batch") {
+    return batch(argc-2, &argv[2], scallop, scallop_key);
+  }
+  scallop(argc-1, &argv[1]);
   return 0;
 }
     
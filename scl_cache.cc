@@ -0,0 +1,159 @@
+#include <iostream>
+#include <string>
+#include <sstream>
+#include <cstdlib>
+#include <unordered_map>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <gmp.h>
+
+#include "scl_cache.h"
+
+
+struct SclCacheEntry {
+  std::string scl;
+  std::string solver;
+  double seconds;
+};
+
+static bool cache_on = false;
+static int cache_fd = -1;
+static std::string cache_filename = "";
+static off_t indexed_size = 0;      //the log is indexed up to here
+static std::unordered_map<std::string, SclCacheEntry> cache_index;
+
+static const char* solver_name(SparseLPSolver s) {
+  switch (s) {
+    case GLPK:
+    case GLPK_SIMPLEX:
+      return "GLPK";
+    case GLPK_IPT:
+      return "GIPT";
+    case GUROBI:
+    case GUROBI_SIMPLEX:
+    case GUROBI_IPT:
+      return "GUROBI";
+    case EXLP:
+      return "EXLP";
+    case GLPK_EXACT:
+      return "HYBRID";
+  }
+  return "?";
+}
+
+static bool is_exact(const std::string& solver) {
+  return (solver == "EXLP" || solver == "HYBRID");
+}
+
+//index any whole lines which have been appended since last time
+static void refresh(void) {
+  struct stat st;
+  if (fstat(cache_fd, &st) != 0 || st.st_size <= indexed_size) {
+    return;
+  }
+  off_t page = sysconf(_SC_PAGESIZE);
+  off_t map_start = indexed_size - (indexed_size % page);
+  size_t map_len = st.st_size - map_start;
+  void* map = mmap(NULL, map_len, PROT_READ, MAP_SHARED, cache_fd, map_start);
+  if (map == MAP_FAILED) {
+    return;
+  }
+  const char* data = (const char*)map + (indexed_size - map_start);
+  size_t len = st.st_size - indexed_size;
+  size_t line_start = 0;
+  for (size_t i=0; i<len; ++i) {
+    if (data[i] != '\n') {
+      continue;
+    }
+    std::string line(data + line_start, i - line_start);
+    line_start = i+1;
+    size_t t1 = line.find('\t');
+    size_t t2 = (t1 == std::string::npos ? t1 : line.find('\t', t1+1));
+    size_t t3 = (t2 == std::string::npos ? t2 : line.find('\t', t2+1));
+    if (t3 == std::string::npos) {
+      continue;
+    }
+    SclCacheEntry E;
+    E.scl = line.substr(t1+1, t2-t1-1);
+    E.solver = line.substr(t2+1, t3-t2-1);
+    E.seconds = atof(line.substr(t3+1).c_str());
+    std::string key = line.substr(0, t1);
+    //an exact answer is never replaced by an inexact one
+    std::unordered_map<std::string, SclCacheEntry>::iterator it = cache_index.find(key);
+    if (it == cache_index.end() || !is_exact(it->second.solver) || is_exact(E.solver)) {
+      cache_index[key] = E;
+    }
+  }
+  //a partly written last line waits for the next refresh
+  indexed_size += line_start;
+  munmap(map, map_len);
+}
+
+void SCLCACHE::use(const std::string& filename) {
+  if (filename == "") {
+    cache_on = false;
+    return;
+  }
+  if (filename != cache_filename) {
+    if (cache_fd >= 0) {
+      close(cache_fd);
+    }
+    cache_index.clear();
+    indexed_size = 0;
+    cache_filename = filename;
+    cache_fd = open(filename.c_str(), O_RDWR | O_APPEND | O_CREAT, 0644);
+  }
+  cache_on = (cache_fd >= 0);
+  if (!cache_on) {
+    std::cout << "Couldn't open the cache " << filename << "; not using it\n";
+    cache_filename = "";
+  }
+}
+
+bool SCLCACHE::enabled(void) {
+  return cache_on;
+}
+
+bool SCLCACHE::lookup(const std::string& key, bool require_exact,
+                      Rational& scl, std::string& solver, double& seconds) {
+  if (!cache_on) {
+    return false;
+  }
+  refresh();
+  std::unordered_map<std::string, SclCacheEntry>::iterator it = cache_index.find(key);
+  if (it == cache_index.end()) {
+    return false;
+  }
+  if (require_exact && !is_exact(it->second.solver)) {
+    return false;
+  }
+  mpq_t q;
+  mpq_init(q);
+  if (mpq_set_str(q, it->second.scl.c_str(), 10) != 0) {
+    mpq_clear(q);
+    return false;
+  }
+  mpq_canonicalize(q);
+  scl = Rational(q);
+  mpq_clear(q);
+  solver = it->second.solver;
+  seconds = it->second.seconds;
+  return true;
+}
+
+void SCLCACHE::store(const std::string& key, Rational& scl,
+                     SparseLPSolver solver, double seconds) {
+  if (!cache_on) {
+    return;
+  }
+  std::ostringstream line;
+  line << key << "\t" << scl << "\t" << solver_name(solver) << "\t" << seconds << "\n";
+  std::string s = line.str();
+  //one write, so that lines from different processes don't interleave
+  if (write(cache_fd, s.c_str(), s.size()) != (ssize_t)s.size()) {
+    std::cout << "Couldn't write to the cache " << cache_filename << "\n";
+  }
+}
@@ -0,0 +1,26 @@
+#ifndef SCL_CACHE_H
+#define SCL_CACHE_H
+
+#include <string>
+
+#include "rational.h"
+#include "lp.h"
+
+//a file of scl values which have already been computed, so that asking
+//for the same chain again (from any process) skips the LP entirely.  The
+//file is an append-only log, one line per answer:
+//  <key> <tab> <scl> <tab> <solver> <tab> <seconds>
+//which is read (via mmap) into an index, and rescanned whenever some
+//process has appended to it.  Nothing happens unless use has been given
+//a filename (this is the --cache option)
+namespace SCLCACHE {
+  void use(const std::string& filename);            //"" turns the cache off
+  bool enabled(void);
+  //an answer from an inexact solver doesn't count if require_exact is set
+  bool lookup(const std::string& key, bool require_exact,
+              Rational& scl, std::string& solver, double& seconds);
+  void store(const std::string& key, Rational& scl,
+             SparseLPSolver solver, double seconds);
+}
+
+#endif
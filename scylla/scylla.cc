@@ -6,16 +6,24 @@
 
 #include <iostream>
 #include <fstream>
+#include <sstream>
 #include <string>
 #include <vector>
 #include <stdlib.h>
 #include <ctype.h>
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include <algorithm>
+#include <unordered_map>
 
 #include "scylla.h"
 #include "scylla_classes.h"
 #include "../rational.h"
 #include "../lp.h"
 #include "../word.h"
+#include "../stats.h"
+#include "../scl_cache.h"
 
 
 using namespace SCYLLA;
@@ -129,67 +137,65 @@ void SCYLLA::compute_group_teeth_and_rectangles(Chain &C,
  one in a triangle.  This effectively duplicates the nonrigorous scallop
  (the intention is that it should be faster)
  *****************************************************************************/
-void SCYLLA::compute_central_polys(Chain &C, 
-                           InterfaceEdgeList &IEL, 
-                           std::vector<CentralPolygon> &CP,
-                           bool limit_central_sides) {
-  int i,j,k,l;
+//the central polygons whose first edge starts at letter i, sorted 
+//by kind: out[0] gets the bigons, out[1] the all-interface triangles, 
+//out[2] the triangles with 2 interface edges, and out[3] the ones 
+//with 1 (unless limit_central_sides)
+static void central_polys_starting_at(Chain &C, 
+                                      InterfaceEdgeList &IEL, 
+                                      int i,
+                                      bool limit_central_sides,
+                                      CentralPolygonList* out) {
+  int j,k,l;
   int e1L1, e1L2, e2L1, e2L2, e3L1, e3L2;  //edge1, letter1, etc
   CentralPolygon temp_central_poly;
   
-  CP.resize(0);
-  
   //first, enumerate all polys with two sides.  These are 
   //always both interface edges.  We may always assume that 
   //the smallest letter is at position 0
-  temp_central_poly.edges.resize(2);
-  temp_central_poly.interface = std::vector<bool>(2, true);
-  for (i=0; i<(int)C.chain_letters.size(); i++) {               //the first letter
-    e1L1 = i;
-    for (j=0; j<(int)IEL.edges_beginning_with[i].size(); j++) { //which edge we are thinking about
-      e1L2 = IEL[IEL.edges_beginning_with[i][j]].last;
-      e2L1 = C.next_letter(e1L2);
-      if (e2L1 < e1L1) {
-        continue;
-      }
-      for (k=0; k<(int)IEL.edges_beginning_with[e2L1].size(); k++) {
-        e2L2 = IEL[IEL.edges_beginning_with[e2L1][k]].last;
-        if (e2L2 == C.prev_letter(e1L1)) {
-          temp_central_poly.edges[0] = std::make_pair( e1L1, e1L2 );
-          temp_central_poly.edges[1] = std::make_pair( e2L1, e2L2 );
-          CP.push_back(temp_central_poly);
-          break;
-        }
+  temp_central_poly.num_sides = 2;
+  temp_central_poly.interface = 0x3;
+  e1L1 = i;
+  for (j=0; j<(int)IEL.edges_beginning_with[i].size(); j++) { //which edge we are thinking about
+    e1L2 = IEL[IEL.edges_beginning_with[i][j]].last;
+    e2L1 = C.next_letter(e1L2);
+    if (e2L1 < e1L1) {
+      continue;
+    }
+    for (k=0; k<(int)IEL.edges_beginning_with[e2L1].size(); k++) {
+      e2L2 = IEL[IEL.edges_beginning_with[e2L1][k]].last;
+      if (e2L2 == C.prev_letter(e1L1)) {
+        temp_central_poly.edges[0] = std::make_pair( e1L1, e1L2 );
+        temp_central_poly.edges[1] = std::make_pair( e2L1, e2L2 );
+        out[0].push_back(temp_central_poly);
+        break;
       }
     }
   }
   
   //enumerate all polys with three sides, all interface
-  temp_central_poly.edges.resize(3);
-  temp_central_poly.interface = std::vector<bool>(3, true);
-  for (i=0; i<(int)C.chain_letters.size(); i++) {               //the first letter
-    e1L1 = i;
-    for (j=0; j<(int)IEL.edges_beginning_with[i].size(); j++) { //which edge we are thinking about
-      e1L2 = IEL[IEL.edges_beginning_with[i][j]].last;
-      e2L1 = C.next_letter(e1L2);
-      if (e2L1 < e1L1) {  //if first letter isn't smallest
+  temp_central_poly.num_sides = 3;
+  temp_central_poly.interface = 0x7;
+  for (j=0; j<(int)IEL.edges_beginning_with[i].size(); j++) { //which edge we are thinking about
+    e1L2 = IEL[IEL.edges_beginning_with[i][j]].last;
+    e2L1 = C.next_letter(e1L2);
+    if (e2L1 < e1L1) {  //if first letter isn't smallest
+      continue;
+    }
+    for (k=0; k<(int)IEL.edges_beginning_with[e2L1].size(); k++) {
+      e2L2 = IEL[IEL.edges_beginning_with[e2L1][k]].last;
+      e3L1 = C.next_letter(e2L2);      
+      if (e3L1 < e1L1) {  //if first letter isn't smallest
         continue;
       }
-      for (k=0; k<(int)IEL.edges_beginning_with[e2L1].size(); k++) {
-        e2L2 = IEL[IEL.edges_beginning_with[e2L1][k]].last;
-        e3L1 = C.next_letter(e2L2);      
-        if (e3L1 < e1L1) {  //if first letter isn't smallest
-          continue;
-        }
-        for (l=0; l<(int)IEL.edges_beginning_with[e3L1].size(); l++) {
-          e3L2 = IEL[IEL.edges_beginning_with[e3L1][l]].last;
-          if (e3L2 == C.prev_letter(e1L1)) {
-            temp_central_poly.edges[0] = std::make_pair( e1L1, e1L2 );
-            temp_central_poly.edges[1] = std::make_pair( e2L1, e2L2 );
-            temp_central_poly.edges[2] = std::make_pair( e3L1, e3L2 );
-            CP.push_back(temp_central_poly);
-            break;
-          }
+      for (l=0; l<(int)IEL.edges_beginning_with[e3L1].size(); l++) {
+        e3L2 = IEL[IEL.edges_beginning_with[e3L1][l]].last;
+        if (e3L2 == C.prev_letter(e1L1)) {
+          temp_central_poly.edges[0] = std::make_pair( e1L1, e1L2 );
+          temp_central_poly.edges[1] = std::make_pair( e2L1, e2L2 );
+          temp_central_poly.edges[2] = std::make_pair( e3L1, e3L2 );
+          out[1].push_back(temp_central_poly);
+          break;
         }
       }
     }
@@ -197,24 +203,19 @@ void SCYLLA::compute_central_polys(Chain &C,
   
   //enumerate all polys with three sides, 2 interface
   //we can no longer assume the first one is the smallest letter
-  temp_central_poly.edges.resize(3);
-  temp_central_poly.interface = std::vector<bool>(3, true);
-  temp_central_poly.interface[2] = false;
-  for (i=0; i<(int)C.chain_letters.size(); i++) {               //the first letter
-    e1L1 = i;
-    for (j=0; j<(int)IEL.edges_beginning_with[i].size(); j++) { //which edge we are thinking about
-      e1L2 = IEL[IEL.edges_beginning_with[i][j]].last;
-      e2L1 = C.next_letter(e1L2);   
-      for (k=0; k<(int)IEL.edges_beginning_with[e2L1].size(); k++) {
-        e2L2 = IEL[IEL.edges_beginning_with[e2L1][k]].last;
-        if (C.next_letter(e2L2) == e1L1) { //this is really a bigon
-          continue;
-        }
-        temp_central_poly.edges[0] = std::make_pair( e1L1, e1L2 );
-        temp_central_poly.edges[1] = std::make_pair( e2L1, e2L2 );
-        temp_central_poly.edges[2] = std::make_pair( e2L2, e1L1 );
-        CP.push_back(temp_central_poly);
+  temp_central_poly.interface = 0x3;
+  for (j=0; j<(int)IEL.edges_beginning_with[i].size(); j++) { //which edge we are thinking about
+    e1L2 = IEL[IEL.edges_beginning_with[i][j]].last;
+    e2L1 = C.next_letter(e1L2);   
+    for (k=0; k<(int)IEL.edges_beginning_with[e2L1].size(); k++) {
+      e2L2 = IEL[IEL.edges_beginning_with[e2L1][k]].last;
+      if (C.next_letter(e2L2) == e1L1) { //this is really a bigon
+        continue;
       }
+      temp_central_poly.edges[0] = std::make_pair( e1L1, e1L2 );
+      temp_central_poly.edges[1] = std::make_pair( e2L1, e2L2 );
+      temp_central_poly.edges[2] = std::make_pair( e2L2, e1L1 );
+      out[2].push_back(temp_central_poly);
     }
   }
   
@@ -224,36 +225,89 @@ void SCYLLA::compute_central_polys(Chain &C,
   
   //enumerate all polys with three sides, 1 interface
   //we can no longer assume the first one is the smallest letter
-  temp_central_poly.edges.resize(3);
-  temp_central_poly.interface = std::vector<bool>(3, false);
-  temp_central_poly.interface[0] = true;
-  for (i=0; i<(int)C.chain_letters.size(); i++) {               //the first letter
-    e1L1 = i;
-    for (j=0; j<(int)IEL.edges_beginning_with[i].size(); j++) { //which edge we are thinking about
-      e1L2 = IEL[IEL.edges_beginning_with[i][j]].last;
-      e2L1 = e1L2;     
-      for (e2L2 = 0; e2L2<(int)C.chain_letters.size(); e2L2++) {
-        if (e2L2 == C.next_letter(e2L1)) {
-          continue;
-        }
-        e3L1 = C.prev_letter(e2L2); //this is really weird
-        e3L2 = e1L1;
-        if (e3L2 == C.next_letter(e3L1)) {
-          continue;
-        }
-        temp_central_poly.edges[0] = std::make_pair( e1L1, e1L2 );
-        temp_central_poly.edges[1] = std::make_pair( e2L1, e2L2 );
-        temp_central_poly.edges[2] = std::make_pair( e3L1, e3L2 );
-        CP.push_back(temp_central_poly);       
+  temp_central_poly.interface = 0x1;
+  for (j=0; j<(int)IEL.edges_beginning_with[i].size(); j++) { //which edge we are thinking about
+    e1L2 = IEL[IEL.edges_beginning_with[i][j]].last;
+    e2L1 = e1L2;     
+    for (e2L2 = 0; e2L2<(int)C.chain_letters.size(); e2L2++) {
+      if (e2L2 == C.next_letter(e2L1)) {
+        continue;
       }
+      e3L1 = C.prev_letter(e2L2); //this is really weird
+      e3L2 = e1L1;
+      if (e3L2 == C.next_letter(e3L1)) {
+        continue;
+      }
+      temp_central_poly.edges[0] = std::make_pair( e1L1, e1L2 );
+      temp_central_poly.edges[1] = std::make_pair( e2L1, e2L2 );
+      temp_central_poly.edges[2] = std::make_pair( e3L1, e3L2 );
+      out[3].push_back(temp_central_poly);       
     }
   }
+}
+
+//the letters are handed out one at a time, so the threads stay busy 
+//even though the later letters have fewer polygons
+static void central_polys_worker(Chain *C, 
+                                 InterfaceEdgeList *IEL, 
+                                 bool limit_central_sides,
+                                 std::atomic<int> *next_letter,
+                                 std::vector<CentralPolygonList> *by_letter) {
+  int i;
+  int num_letters = (int)C->chain_letters.size();
+  while ((i = (*next_letter)++) < num_letters) {
+    central_polys_starting_at(*C, *IEL, i, limit_central_sides, &(*by_letter)[4*i]);
+  }
+}
+
+void SCYLLA::compute_central_polys(Chain &C, 
+                           InterfaceEdgeList &IEL, 
+                           CentralPolygonList &CP,
+                           bool limit_central_sides,
+                           int num_threads) {
+  int i,k,t;
+  int num_letters = (int)C.chain_letters.size();
   
+  CP.clear();
+  
+  //each letter gets its own buffer for each kind of polygon, and 
+  //they are concatenated kind by kind and letter by letter, so the 
+  //order doesn't depend on the number of threads
+  std::vector<CentralPolygonList> by_letter(4*num_letters);
+  if (num_threads > num_letters) {
+    num_threads = num_letters;
+  }
+  if (num_threads <= 1) {
+    for (i=0; i<num_letters; i++) {
+      central_polys_starting_at(C, IEL, i, limit_central_sides, &by_letter[4*i]);
+    }
+  } else {
+    std::atomic<int> next_letter(0);
+    std::vector<std::thread> threads(0);
+    for (t=0; t<num_threads; t++) {
+      threads.push_back(std::thread(central_polys_worker, &C, &IEL, 
+                                    limit_central_sides, &next_letter, &by_letter));
+    }
+    for (t=0; t<num_threads; t++) {
+      threads[t].join();
+    }
+  }
+  
+  int num_polys = 0;
+  for (i=0; i<4*num_letters; i++) {
+    num_polys += by_letter[i].size();
+  }
+  CP.reserve(num_polys);
+  for (k=0; k<4; k++) {
+    for (i=0; i<num_letters; i++) {
+      CP.append(by_letter[4*i+k]);
+    }
+  }
 }
 
 
 
-void SCYLLA::print_central_polys(std::vector<CentralPolygon> &CP, 
+void SCYLLA::print_central_polys(CentralPolygonList &CP, 
                          std::ostream &os, 
                          int level) {
   int i;
@@ -293,6 +347,309 @@ void SCYLLA::print_group_teeth_and_rectangles(std::vector<GroupTooth> &GT,
       
 
 
+/*****************************************************************************
+ * the quotient of the LP by the symmetries of the chain.  A symmetry 
+ * carries columns to columns and rows to rows (or, for a central edge 
+ * pair, to minus a row), so averaging an optimal solution over the 
+ * symmetries gives one which is constant on each orbit of columns.  In 
+ * terms of z = the sum of the columns in an orbit, the LP has one column 
+ * per orbit of columns (the column of any one of them) and one row per 
+ * orbit of rows (the signed sum of the rows in it).  For the word rows 
+ * to be permuted too, the quotient asks for every letter of a word to be 
+ * used weight times, rather than just the first one; this is the same, 
+ * as all the letters of a word are used the same number of times
+ * ***************************************************************************/
+struct LPQuotient {
+  std::vector<int> col_orbit;     //the quotient column of each column
+  std::vector<int> orbit_size;    //the number of columns in each orbit
+  std::vector<int> rep;           //one column in each orbit
+  std::vector<int> row_class;     //the quotient row of each row (-1 if it's 0=0)
+  std::vector<int> row_sign;      //row = row_sign * the quotient row, on the orbits
+  std::vector<int> class_RHS;
+  int num_rows;
+};
+
+//a column as a tuple which doesn't depend on how it's listed: its kind, 
+//and then its letters (for a polygon with all sides interface, starting 
+//from the smallest first letter, as compute_central_polys lists them)
+struct ColumnKey {
+  int v[9];
+  bool operator<(const ColumnKey &other) const {
+    return std::lexicographical_compare(v, v+9, other.v, other.v+9);
+  }
+  bool operator==(const ColumnKey &other) const {
+    return std::equal(v, v+9, other.v);
+  }
+};
+
+struct ColumnKeyHash {
+  size_t operator()(const ColumnKey &k) const {
+    size_t h = 0;
+    for (int i=0; i<9; i++) {
+      h = h*1000003 ^ (size_t)k.v[i];
+    }
+    return h;
+  }
+};
+
+static ColumnKey column_key(int col,
+                            CentralPolygonList &CP,
+                            std::vector<GroupTooth> &GT,
+                            std::vector<GroupRectangle> &GR,
+                            const std::vector<int> &sigma) {
+  ColumnKey k;
+  std::fill(k.v, k.v+9, -1);
+  if (col < CP.size()) {
+    int n = CP.num_sides[col];
+    int start = 0;
+    if (n == 2 || CP.interface[col] == 0x7) {
+      for (int j=1; j<n; j++) {
+        if (sigma[CP.first[3*col+j]] < sigma[CP.first[3*col+start]]) {
+          start = j;
+        }
+      }
+    }
+    k.v[0] = 0;
+    k.v[1] = n;
+    k.v[2] = CP.interface[col];
+    for (int j=0; j<n; j++) {
+      k.v[3+2*j] = sigma[CP.first[3*col + (start+j)%n]];
+      k.v[4+2*j] = sigma[CP.last[3*col + (start+j)%n]];
+    }
+    return k;
+  }
+  col -= CP.size();
+  if (col < (int)GT.size()) {
+    k.v[0] = 1;
+    k.v[1] = (GT[col].inverse ? 1 : 0);
+    k.v[2] = GT[col].group_index;
+    k.v[3] = GT[col].position;
+    k.v[4] = sigma[GT[col].base_letter];
+    k.v[5] = sigma[GT[col].first];
+    k.v[6] = sigma[GT[col].last];
+    return k;
+  }
+  col -= GT.size();
+  k.v[0] = 2;
+  k.v[1] = GR[col].group_index;
+  k.v[2] = sigma[GR[col].first];
+  k.v[3] = sigma[GR[col].last];
+  return k;
+}
+
+static void compute_lp_quotient(Chain &C,
+                                ChainSymmetry &S,
+                                InterfaceEdgeList &IEL,
+                                CentralEdgePairList &CEL,
+                                CentralPolygonList &CP,
+                                std::vector<GroupTooth> &GT,
+                                std::vector<GroupRectangle> &GR,
+                                std::vector<std::vector<std::vector<int> > > &group_teeth_rows_reg,
+                                std::vector<std::vector<std::vector<int> > > &group_teeth_rows_inv,
+                                int num_equality_rows,
+                                LPQuotient &Q) {
+  int i,j,k,h,r;
+  int num_H = S.size();
+  int num_cols = CP.size() + GT.size() + GR.size();
+  int num_words = C.num_words();
+  int num_rows = num_equality_rows + num_words;
+  
+  //COLUMNS: an orbit is named by the least key of its columns
+  std::unordered_map<ColumnKey, int, ColumnKeyHash> orbit_of;
+  std::vector<ColumnKey> images(num_H);
+  Q.col_orbit.resize(num_cols);
+  Q.orbit_size.resize(0);
+  Q.rep.resize(0);
+  for (i=0; i<num_cols; i++) {
+    for (h=0; h<num_H; h++) {
+      images[h] = column_key(i, CP, GT, GR, S.perms[h]);
+    }
+    ColumnKey least = *std::min_element(images.begin(), images.end());
+    std::unordered_map<ColumnKey, int, ColumnKeyHash>::iterator it = orbit_of.find(least);
+    if (it != orbit_of.end()) {
+      Q.col_orbit[i] = it->second;
+      continue;
+    }
+    std::sort(images.begin(), images.end());
+    Q.col_orbit[i] = Q.rep.size();
+    orbit_of[least] = Q.rep.size();
+    Q.rep.push_back(i);
+    Q.orbit_size.push_back(std::unique(images.begin(), images.end()) - images.begin());
+  }
+  
+  //ROWS: where each symmetry takes each row, and with what sign
+  //(the teeth rows are found from their letters, base letters and positions)
+  std::vector<int> tooth_row_letter(num_equality_rows, -1);
+  std::vector<int> tooth_row_base(num_equality_rows, -1);
+  std::vector<int> tooth_row_position(num_equality_rows, -1);
+  std::vector<bool> tooth_row_inverse(num_equality_rows, false);
+  for (i=0; i<(C.G)->num_groups(); i++) {
+    int ord = (C.G)->index_order(i);
+    for (j=0; j<(int)group_teeth_rows_reg[i].size(); j++) {
+      for (k=0; k<(int)group_teeth_rows_reg[i][j].size(); k++) {
+        for (int p=0; p<ord-1; p++) {
+          tooth_row_letter[group_teeth_rows_reg[i][j][k]+p] = C.regular_letters[i][j];
+          tooth_row_base[group_teeth_rows_reg[i][j][k]+p] = C.regular_letters[i][k];
+          tooth_row_position[group_teeth_rows_reg[i][j][k]+p] = p;
+        }
+      }
+    }
+    for (j=0; j<(int)group_teeth_rows_inv[i].size(); j++) {
+      for (k=0; k<(int)group_teeth_rows_inv[i][j].size(); k++) {
+        for (int p=0; p<ord-1; p++) {
+          tooth_row_letter[group_teeth_rows_inv[i][j][k]+p] = C.inverse_letters[i][j];
+          tooth_row_base[group_teeth_rows_inv[i][j][k]+p] = C.inverse_letters[i][k];
+          tooth_row_position[group_teeth_rows_inv[i][j][k]+p] = p;
+          tooth_row_inverse[group_teeth_rows_inv[i][j][k]+p] = true;
+        }
+      }
+    }
+  }
+  std::vector<int> word_letter(num_words, -1);
+  std::vector<int> word_length(num_words, 0);
+  for (i=0; i<C.num_letters(); i++) {
+    word_length[C.chain_letters[i].word]++;
+    if (C.chain_letters[i].index == 0) {
+      word_letter[C.chain_letters[i].word] = i;
+    }
+  }
+  
+  std::vector<int> least_row(num_rows);
+  std::vector<int> least_sign(num_rows);
+  std::vector<bool> vanishes(num_rows, false);
+  for (r=0; r<num_rows; r++) {
+    least_row[r] = r;
+    least_sign[r] = 1;
+    for (h=1; h<num_H; h++) {
+      const std::vector<int> &sigma = S.perms[h];
+      int image, sign = 1;
+      if (r < IEL.size()) {
+        image = IEL.get_index_from_poly_side(sigma[IEL[r].first], sigma[IEL[r].last]);
+      } else if (r < IEL.size() + CEL.size()) {
+        CentralEdgePair E = CEL[r - IEL.size()];
+        int v = CEL.get_index(sigma[E.first], sigma[E.last]);
+        image = IEL.size() + abs(v)-1;
+        sign = (v < 0 ? -1 : 1);
+      } else if (r < num_equality_rows) {
+        const ChainLetter &L = C.chain_letters[sigma[tooth_row_letter[r]]];
+        const ChainLetter &B = C.chain_letters[sigma[tooth_row_base[r]]];
+        std::vector<std::vector<std::vector<int> > > &table 
+                    = (tooth_row_inverse[r] ? group_teeth_rows_inv : group_teeth_rows_reg);
+        image = table[L.group][L.index_in_group_reg_inv_list][B.index_in_group_reg_inv_list]
+                + tooth_row_position[r];
+      } else {
+        image = num_equality_rows + C.chain_letters[sigma[word_letter[r-num_equality_rows]]].word;
+      }
+      if (image < least_row[r]) {
+        least_row[r] = image;
+        least_sign[r] = sign;
+      }
+      //a symmetry which fixes the row but negates it means it's 0 = 0
+      if (image == r && sign == -1) {
+        vanishes[r] = true;
+      }
+    }
+  }
+  Q.row_class.assign(num_rows, -1);
+  Q.row_sign.assign(num_rows, 1);
+  Q.class_RHS.resize(0);
+  Q.num_rows = 0;
+  for (r=0; r<num_rows; r++) {
+    if (vanishes[r]) {
+      continue;
+    }
+    if (least_row[r] == r) {
+      Q.row_class[r] = Q.num_rows;
+      Q.class_RHS.push_back(0);
+      Q.num_rows++;
+    } else {
+      Q.row_class[r] = Q.row_class[least_row[r]];
+    }
+    Q.row_sign[r] = least_sign[r];
+    if (r >= num_equality_rows) {
+      Q.class_RHS[Q.row_class[r]] += word_length[r-num_equality_rows] * C.weights[r-num_equality_rows];
+    }
+  }
+}
+
+
+//set up and solve the quotient LP, and spread the solution back over 
+//the orbits
+static void scylla_quotient_lp(Chain &C,
+                               InterfaceEdgeList &IEL,
+                               CentralEdgePairList &CEL,
+                               CentralPolygonList &CP,
+                               std::vector<GroupTooth> &GT,
+                               std::vector<GroupRectangle> &GR,
+                               std::vector<std::vector<std::vector<int> > > &group_teeth_rows_reg,
+                               std::vector<std::vector<std::vector<int> > > &group_teeth_rows_inv,
+                               int num_equality_rows,
+                               LPQuotient &Q,
+                               Rational* scl,
+                               std::vector<Rational>* solution_vector,
+                               SparseLPSolver solver,
+                               int VERBOSE) {
+  int i,j;
+  int num_cols = Q.rep.size();
+  std::vector<int> rows(0);
+  std::vector<int> vals(0);
+  
+  SparseLP LP(solver, Q.num_rows, num_cols);
+  for (i=0; i<Q.num_rows; i++) {
+    LP.set_RHS(i, Q.class_RHS[i]);
+    LP.set_equality_type(i, EQ);
+  }
+  
+  for (i=0; i<num_cols; i++) {
+    int col = Q.rep[i];
+    LP.begin_column(i);
+    if (col < CP.size()) {
+      CentralPolygon P = CP[col];
+      LP.set_obj(i, -P.chi_times_2());
+      P.compute_column(C, IEL, CEL, rows, vals);
+    } else if (col < CP.size() + (int)GT.size()) {
+      GroupTooth &T = GT[col - CP.size()];
+      LP.set_obj(i, -T.chi_times_2(C));
+      T.compute_edge_column(C, IEL, (T.inverse ? group_teeth_rows_inv : group_teeth_rows_reg), 
+                            rows, vals);
+      rows.push_back(num_equality_rows + C.chain_letters[T.first].word);
+      vals.push_back(1);
+    } else {
+      GroupRectangle &R = GR[col - CP.size() - GT.size()];
+      LP.set_obj(i, 0);
+      R.compute_edge_column(IEL, rows, vals);
+      rows.push_back(num_equality_rows + C.chain_letters[R.first].word);
+      vals.push_back(1);
+      rows.push_back(num_equality_rows + C.chain_letters[R.last].word);
+      vals.push_back(1);
+    }
+    for (j=0; j<(int)rows.size(); j++) {
+      if (Q.row_class[rows[j]] >= 0) {
+        LP.add_entry(Q.row_class[rows[j]], i, Q.row_sign[rows[j]] * vals[j]);
+      }
+    }
+  }
+  
+  if (VERBOSE > 2) {
+    std::cout << "Quotient LP problem:\n";
+    LP.print_LP();
+  }
+  
+  STATS::phase("solve");
+  LP.solve(VERBOSE);
+  
+  STATS::phase("recovery");
+  LP.get_optimal_value(*scl);
+  std::vector<Rational> z(0);
+  LP.get_soln_vector(z);
+  solution_vector->resize(Q.col_orbit.size());
+  for (i=0; i<(int)Q.col_orbit.size() && (int)z.size() == num_cols; i++) {
+    int orbit = Q.col_orbit[i];
+    (*solution_vector)[i] = z[orbit] / Rational(Q.orbit_size[orbit], 1);
+  }
+}
+
+
 /****************************************************************************
  * The columns are the central polygons, followed by the group teeth, 
  * followed by the group rectangles
@@ -308,17 +665,20 @@ void SCYLLA::print_group_teeth_and_rectangles(std::vector<GroupTooth> &GT,
 void SCYLLA::scylla_lp(Chain& C, 
                InterfaceEdgeList &IEL,
                CentralEdgePairList &CEL, 
-               std::vector<CentralPolygon> &CP,
+               CentralPolygonList &CP,
                std::vector<GroupTooth> &GT,
                std::vector<GroupRectangle> &GR,
                Rational* scl, 
                std::vector<Rational>* solution_vector, 
+               std::vector<Rational>* dual_vector, 
+               std::vector<double>* double_dual_vector, 
                SparseLPSolver solver, 
                bool WRITE_LP,
                std::string LP_filename,
                bool cl_not_scl,
                int VERBOSE,
-               int LP_VERBOSE) {
+               int LP_VERBOSE,
+               ChainSymmetry* symmetry) {
   int i,j,k,m;
   int ord;
   int num_cols, offset, num_rows;
@@ -327,6 +687,8 @@ void SCYLLA::scylla_lp(Chain& C,
   int c_edge_pairs = CEL.size();
   int num_words = C.num_words();
   
+  STATS::phase("lp_setup");
+  
   
   //ROWS (see above)
   //we need to construct something to tell us the row 
@@ -369,6 +731,22 @@ void SCYLLA::scylla_lp(Chain& C,
   
   num_cols = CP.size() + GT.size() + GR.size();
   
+  if (symmetry != NULL && symmetry->size() > 1) {
+    LPQuotient Q;
+    compute_lp_quotient(C, *symmetry, IEL, CEL, CP, GT, GR, 
+                        group_teeth_rows_reg, group_teeth_rows_inv, 
+                        num_equality_rows, Q);
+    if (VERBOSE > 1) {
+      std::cout << "The chain has " << symmetry->size() << " symmetries; the quotient LP has "
+                << Q.rep.size() << " columns (of " << num_cols << ") and " 
+                << Q.num_rows << " rows (of " << num_rows << ")\n";
+    }
+    scylla_quotient_lp(C, IEL, CEL, CP, GT, GR, 
+                       group_teeth_rows_reg, group_teeth_rows_inv, 
+                       num_equality_rows, Q, scl, solution_vector, solver, VERBOSE);
+    return;
+  }
+  
   if (VERBOSE > 2) {
     std::cout << "Num equality rows: " << num_equality_rows
     << "Num rows: " << num_rows << "\n";
@@ -438,7 +816,10 @@ void SCYLLA::scylla_lp(Chain& C,
   }    
   
   //CENTRAL POLYGONS
+  //the entries go in a column at a time, so the LP can store them 
+  //compressed by column
   for (i=0; i<(int)CP.size(); i++) {
+    LP.begin_column(i);
     CP[i].compute_ia_etc_for_edges(i,
                                    C,
                                    IEL, 
@@ -453,9 +834,12 @@ void SCYLLA::scylla_lp(Chain& C,
     std::cout << "Loaded central polygon edge constraints\n";
   }     
   
-  //GROUP TEETH and RECTANGLES
+  //GROUP TEETH and RECTANGLES, together with the word constraints: for every 
+  //group rectangle and group polygon, for every edge, put a 1 in the 
+  //row corresponding to the word for the first letter
   offset = CP.size();
   for (m=0; m<(int)GT.size(); m++) {
+    LP.begin_column(offset + m);
     if (GT[m].inverse) {
       if (VERBOSE > 2) {
         std::cout << GT[m] << "\n";
@@ -475,40 +859,25 @@ void SCYLLA::scylla_lp(Chain& C,
                                      group_teeth_rows_reg, 
                                      LP);
     }
+    GT[m].compute_ia_etc_for_words(offset + m, C, num_equality_rows, LP);
   }
   offset = CP.size() + GT.size();
   for (m=0; m<(int)GR.size(); m++) {
+    LP.begin_column(offset + m);
     if (VERBOSE>2) {
       std::cout << GR[m] << "\n";
     }
     GR[m].compute_ia_etc_for_edges(offset + m, IEL, LP);
-  }
-  
-  
-  if (VERBOSE>1) {
-    std::cout << "Loaded group constraints\n";
-  }
-  
-  //word constraints: for every group rectangle and group polygon, for every edge, put a 1 in the 
-  //row corresponding to the word for the first letter
-  offset = CP.size();
-  for (j=0; j<(int)GT.size(); j++) {
-    GT[j].compute_ia_etc_for_words(offset + j, C, num_equality_rows, LP);
-  }
-  offset = CP.size() + GT.size();
-  for (j=0; j<(int)GR.size(); j++) {
-    if (VERBOSE > 2) {
-      std::cout << "word cons GR " << GR[j] << "\n";
-    }
-    GR[j].compute_ia_etc_for_words(offset + j, 
+    GR[m].compute_ia_etc_for_words(offset + m, 
                                    C, 
                                    num_equality_rows, 
                                    IEL,
                                    LP);
   }
   
-  if (VERBOSE > 1) {
-    std::cout << "Loaded word constraints\n";
+  
+  if (VERBOSE>1) {
+    std::cout << "Loaded group and word constraints\n";
   }
   
   
@@ -522,12 +891,150 @@ void SCYLLA::scylla_lp(Chain& C,
     LP.print_LP();
   }
   
+  STATS::phase("solve");
   LP.solve(VERBOSE);
   
+  STATS::phase("recovery");
   LP.get_optimal_value(*scl);
   LP.get_soln_vector(*solution_vector);
+  if (dual_vector != NULL) {
+    LP.get_dual_vector(*dual_vector);
+  }
+  if (double_dual_vector != NULL) {
+    LP.get_dual_vector(*double_dual_vector);
+  }
   
+}
+
+
+
+/*****************************************************************************
+ * delayed column generation.  The 1-interface triangles are most of the 
+ * columns, but few of them are used, so we start without them (as with 
+ * -l) and only add the ones with negative reduced cost under the duals 
+ * of the current LP, until there are none.  The answer is the same as 
+ * with all the polygons.
+ * ***************************************************************************/
+
+//run through the 1-interface triangles in the same order as 
+//compute_central_polys, and add to CP the ones which aren't there 
+//yet and have negative reduced cost (or all of them, if there are no 
+//duals); returns how many were added
+template <typename T>
+static int add_priced_triangles(Chain &C, 
+                                InterfaceEdgeList &IEL,
+                                CentralEdgePairList &CEL,
+                                CentralPolygonList &CP,
+                                std::vector<bool> &in_CP,
+                                std::vector<T> &duals) {
+  int i,j,k,t;
+  int e1L1, e1L2, e2L1, e2L2, e3L1, e3L2;
+  int num_added = 0;
+  CentralPolygon temp_central_poly;
+  std::vector<int> rows(0);
+  std::vector<int> vals(0);
   
+  temp_central_poly.num_sides = 3;
+  temp_central_poly.interface = 0x1;
+  t = 0;
+  for (i=0; i<(int)C.chain_letters.size(); i++) {
+    e1L1 = i;
+    for (j=0; j<(int)IEL.edges_beginning_with[i].size(); j++) {
+      e1L2 = IEL[IEL.edges_beginning_with[i][j]].last;
+      e2L1 = e1L2;     
+      for (e2L2 = 0; e2L2<(int)C.chain_letters.size(); e2L2++) {
+        if (e2L2 == C.next_letter(e2L1)) {
+          continue;
+        }
+        e3L1 = C.prev_letter(e2L2);
+        e3L2 = e1L1;
+        if (e3L2 == C.next_letter(e3L1)) {
+          continue;
+        }
+        if (t == (int)in_CP.size()) {
+          in_CP.push_back(false);
+        }
+        if (in_CP[t]) {
+          t++;
+          continue;
+        }
+        temp_central_poly.edges[0] = std::make_pair( e1L1, e1L2 );
+        temp_central_poly.edges[1] = std::make_pair( e2L1, e2L2 );
+        temp_central_poly.edges[2] = std::make_pair( e3L1, e3L2 );
+        if ((int)duals.size() > 0) {
+          temp_central_poly.compute_column(C, IEL, CEL, rows, vals);
+          T reduced_cost = T(-temp_central_poly.chi_times_2());
+          for (k=0; k<(int)rows.size(); ++k) {
+            reduced_cost = reduced_cost - duals[rows[k]]*vals[k];
+          }
+          if (!is_negative(reduced_cost)) {
+            t++;
+            continue;
+          }
+        }
+        CP.push_back(temp_central_poly);
+        in_CP[t] = true;
+        num_added++;
+        t++;
+      }
+    }
+  }
+  return num_added;
+}
+
+//CP should start out as the polygons from compute_central_polys with 
+//limit_central_sides set
+void SCYLLA::scylla_lp_column_generation(Chain& C, 
+                                         InterfaceEdgeList &IEL,
+                                         CentralEdgePairList &CEL, 
+                                         CentralPolygonList &CP,
+                                         std::vector<GroupTooth> &GT,
+                                         std::vector<GroupRectangle> &GR,
+                                         Rational* scl, 
+                                         std::vector<Rational>* solution_vector, 
+                                         SparseLPSolver solver, 
+                                         int VERBOSE,
+                                         int LP_VERBOSE) {
+  bool exact = gives_exact_duals(solver);
+  std::vector<Rational> duals(0);
+  std::vector<double> double_duals(0);
+  std::vector<bool> in_CP(0);
+  int num_added;
+  for (int round=0; ; ++round) {
+    scylla_lp(C, IEL, CEL, CP, GT, GR, 
+              scl, 
+              solution_vector, 
+              (exact ? &duals : NULL), 
+              (exact ? NULL : &double_duals), 
+              solver,
+              false, "",
+              false,
+              VERBOSE,
+              LP_VERBOSE,
+              NULL);
+    if (*scl == -1) {
+      //without those triangles, it may be infeasible; then we add them all
+      duals.resize(0);
+      double_duals.resize(0);
+    }
+    STATS::phase("pricing");
+    if (exact) {
+      num_added = add_priced_triangles(C, IEL, CEL, CP, in_CP, duals);
+    } else {
+      num_added = add_priced_triangles(C, IEL, CEL, CP, in_CP, double_duals);
+    }
+    if (VERBOSE > 1) {
+      std::cout << "Column generation round " << round << ": " 
+                << "scl <= " << *scl << "; added " << num_added 
+                << " triangles (now " << CP.size() << " central polygons)\n";
+      if ((int)duals.size() == 0 && (int)double_duals.size() == 0) {
+        std::cout << "(the solver gave no duals, so we added all of them)\n";
+      }
+    }
+    if (num_added == 0) {
+      break;
+    }
+  }
 }
 
 
@@ -560,12 +1067,129 @@ void SCYLLA::write_solution_to_fatgraph(std::string& output_filename,
                                         Chain& C,
                                         InterfaceEdgeList& IEL,
                                         CentralEdgePairList &CEL, 
-                                        std::vector<CentralPolygon> &CP,
+                                        CentralPolygonList &CP,
                                         std::vector<GroupTooth> &GT,
                                         std::vector<GroupRectangle> &GR,
                                         std::vector<Rational>& solution_vector,
                                         int verbose ) {}
 
+//the key under which the answer for C is kept in the scl cache
+static std::string scylla_cache_key(Chain& C, bool CL, bool limit_central_sides) {
+  return std::string("cyclic ") + (CL ? "cl " : "scl ") + (limit_central_sides ? "-l " : "")
+         + C.canonical_form();
+}
+
+static void print_scl(CyclicProduct& G, Chain& C, Rational& scl, bool CL, int VERBOSE) {
+  if (VERBOSE>0) {
+    if (CL) {
+      std::cout << "cl_{" << G.short_rep() << "}(" << C << ") = " << scl << " = " << scl.get_d() << "\n";
+    } else {
+      std::cout << "scl_{" << G.short_rep() << "}( " << C << ") = " << scl << " = " << scl.get_d() << "\n";    //output the answer
+    } 
+  } else {
+    std::cout << scl.get_d() << "\n";
+  }
+}
+
+//the options (as given) and the canonical form of the chain of a -cyclic 
+//command, which is the same for any two commands which print the same 
+//answer, or "" if the command writes files or doesn't parse.  Unlike 
+//scylla, it never exits on bad input
+std::string SCYLLA::canonical_command(int argc, char** argv) {
+  int current_arg = 0;
+  bool RAW = false;
+  std::string options = "";
+  while (current_arg < argc && argv[current_arg][0] == '-') {
+    char option = argv[current_arg][1];
+    if (option == 'o' || option == 'L' || option == 'h') {
+      return "";
+    }
+    if (option == 'r') {
+      RAW = true;           //the canonical form says for itself if it's raw
+    } else {
+      options += std::string(argv[current_arg]) + " ";
+    }
+    current_arg++;
+  }
+  if (current_arg >= argc) {
+    return "";
+  }
+  
+  std::string first_arg = std::string(argv[current_arg]);
+  std::string G_in = "";
+  if (RAW) {
+    if (first_arg.size() > 0 && first_arg[0] == 'G') {
+      G_in = first_arg.substr(1, first_arg.size()-1);
+      current_arg++;
+    } else {
+      int r = raw_chain_rank(argc-current_arg, argv + current_arg);
+      G_in = "0";
+      for (int i=0; i<r-1; i++) {
+        G_in += ",0";
+      }
+    }
+  } else if (first_arg.size() < 2 || isalpha(first_arg[1])) {
+    int r = chain_rank(argc-current_arg, &argv[current_arg]);
+    for (int i=0; i<r; ++i) {
+      G_in += (char)(97+i);
+      G_in += "0";
+    }
+  } else {
+    G_in = first_arg;
+    current_arg++;
+  }
+  CyclicProduct G(G_in, RAW);
+  
+  std::vector<std::vector<int> > words(0);
+  std::vector<int> weights(0);
+  for ( ; current_arg < argc; ++current_arg) {
+    std::string s = std::string(argv[current_arg]);
+    std::vector<int> w(0);
+    int weight = 1;
+    int j = 0;
+    if (RAW) {
+      if (s.size() > 0 && s[0] == 'w') {
+        while (j < (int)s.size() && s[j] != ',') j++;
+        weight = atoi(s.substr(1, j).c_str());
+        j++;
+      }
+      while (j < (int)s.size()) {
+        int k = j;
+        while (k < (int)s.size() && s[k] != ',') k++;
+        int letter = atoi(s.substr(j, k-j).c_str());
+        if (letter == 0 || abs(letter) > G.num_groups()) {
+          return "";
+        }
+        w.push_back(letter);
+        j = k+1;
+      }
+    } else {
+      while (j < (int)s.size() && isdigit(s[j])) j++;
+      if (j > 0) {
+        weight = atoi(s.substr(0, j).c_str());
+      }
+      for ( ; j < (int)s.size(); ++j) {
+        int g = G.gen_index(s[j]);
+        if (!isalpha(s[j]) || g < 0) {
+          return "";
+        }
+        w.push_back((isupper(s[j]) ? -1 : 1) * (g+1));
+      }
+    }
+    G.cyc_red(w);
+    if ((int)w.size() == 0) {
+      return "";
+    }
+    words.push_back(w);
+    weights.push_back(weight);
+  }
+  if ((int)words.size() == 0) {
+    return "";
+  }
+  std::string form = G.canonical_form(words, weights);
+  return options + (form[0] == 'G' ? "-r " : "") + form;
+}
+
 void SCYLLA::scylla(int argc, char** argv) {
   int current_arg = 0;
   //int i;
@@ -573,15 +1197,19 @@ void SCYLLA::scylla(int argc, char** argv) {
   int LP_VERBOSE = 0;
   SparseLPSolver solver = GLPK_SIMPLEX;
   bool LIMIT_CENTRAL_SIDES = false;
+  bool COLUMN_GENERATION = false;
+  bool USE_SYMMETRY = true;
   bool WRITE_LP = false;
   bool CL = false;
   std::string LP_filename;
   bool WRITE_FATGRAPH = false;
   std::string fatgraph_file = "";
   bool RAW = false;
+  int NUM_THREADS = 1;
+  std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
   
   if (argc < 1 || std::string(argv[0]) == "-h") {
-    std::cout << "usage: ./scallop -cyclic [-h] [-v[n]] [-o <filename>] [-L <filename>] [-l] [-C] [-m<GLPK,GIPT,EXLP,GUROBI>] <gen string> <chain>\n";
+    std::cout << "usage: ./scallop -cyclic [-h] [-v[n]] [-o <filename>] [-L <filename>] [-l] [-G] [-S] [-C] [-t[n]] [-m<GLPK,GIPT,EXLP,HYBRID,GUROBI>] <gen string> <chain>\n";
     std::cout << "\twhere <gen string> is of the form <gen1><order1><gen2><order2>...\n";
     std::cout << "\te.g. a5b0 computes in Z/5Z * Z\n";
     std::cout << "\tand <chain> is an integer linear combination of words in the generators\n";
@@ -591,8 +1219,12 @@ void SCYLLA::scylla(int argc, char** argv) {
     std::cout << "\t-v[n]: verbose output (n=0,1,2,3); 0 gives quiet output\n";
     std::cout << "\t-o <filename>: write out *a* (not necessarily *the*) minimal surface as a fatgraph\n";
     std::cout << "\t-L <filename>: write out a sparse lp to the filename .A, .b, and .c\n";
+    std::cout << "\t-l: only use central triangles with at least two interface edges (faster, but not rigorous)\n";
+    std::cout << "\t-G: start without the other central triangles, and add them by column generation (same answer, smaller LP)\n";
+    std::cout << "\t-S: don't shrink the LP using the symmetries of the chain (rotations of the words)\n";
     std::cout << "\t-C compute commutator length (not scl)\n";
-    std::cout << "\t-m<format>: use the LP solver specified (EXLP uses GMP for exact output)\n";
+    std::cout << "\t-t[n]: enumerate the central polygons with n threads (all cores if n is omitted)\n";
+    std::cout << "\t-m<format>: use the LP solver specified (EXLP uses GMP for exact output; HYBRID solves with GLPK and then checks the answer exactly)\n";
     std::cout << "\t-r: Specify that the input is 'raw', which supports more than 26 factors.\n";
     std::cout << "\t    A 'raw' gen string is of the form 'G0,1,2,2', for 4 groups of orders infinity, 1, 2, 2 respectively\n";
     std::cout << "\t    A 'raw' weighted word is 'w2,1,2,-1,-2' meaning 2*abAB.  The weight is optional.\n";
@@ -605,6 +1237,8 @@ void SCYLLA::scylla(int argc, char** argv) {
         solver = GLPK;
       } else if (argv[current_arg][2] == 'G' && argv[current_arg][3] == 'I') {
         solver = GLPK_IPT;
+      } else if (argv[current_arg][2] == 'H') {
+        solver = GLPK_EXACT;
       } else if (argv[current_arg][2] == 'G') {
         if (argv[current_arg][5] == 'O') {
           solver = GUROBI_SIMPLEX;
@@ -633,9 +1267,22 @@ void SCYLLA::scylla(int argc, char** argv) {
     } else if (argv[current_arg][1] == 'l') {
       LIMIT_CENTRAL_SIDES = true;
     
+    } else if (argv[current_arg][1] == 'G') {
+      COLUMN_GENERATION = true;
+    
+    } else if (argv[current_arg][1] == 'S') {
+      USE_SYMMETRY = false;
+    
     } else if (argv[current_arg][1] == 'C') {
       CL = true;
       
+    } else if (argv[current_arg][1] == 't') {
+      if (argv[current_arg][2] == '\0') {
+        NUM_THREADS = (int)std::thread::hardware_concurrency();
+      } else {
+        NUM_THREADS = atoi(&argv[current_arg][2]);
+      }
+      
     } else if (argv[current_arg][1] == 'o') {
       WRITE_FATGRAPH = true;
       fatgraph_file = std::string(argv[current_arg+1]);
@@ -646,6 +1293,12 @@ void SCYLLA::scylla(int argc, char** argv) {
     }
     current_arg++;
   }
+  if (COLUMN_GENERATION && (CL || WRITE_LP || LIMIT_CENTRAL_SIDES)) {
+    //cl is an integer program, so the duals don't tell us anything, and 
+    //the other two want a fixed set of polygons
+    std::cout << "Column generation can't be used with -C, -L, or -l; ignoring -G\n";
+    COLUMN_GENERATION = false;
+  }
   
   //if the first argument is a group string, then good
   //otherwise, assume it's a free group
@@ -703,14 +1356,38 @@ void SCYLLA::scylla(int argc, char** argv) {
     }
   }
   
+  //if this chain has been done before, the answer is in the cache
+  std::string cache_key = "";
+  if (SCLCACHE::enabled() && !WRITE_LP) {
+    STATS::phase("cache");
+    cache_key = scylla_cache_key(C, CL, LIMIT_CENTRAL_SIDES);
+    Rational cached_scl;
+    std::string cached_solver;
+    double cached_seconds;
+    if (!WRITE_FATGRAPH 
+        && SCLCACHE::lookup(cache_key, solver == EXLP || solver == GLPK_EXACT, 
+                            cached_scl, cached_solver, cached_seconds)) {
+      if (VERBOSE > 1) {
+        std::cout << "Found in the cache (computed with " << cached_solver 
+                  << " in " << cached_seconds << " seconds)\n";
+      }
+      STATS::phase("output");
+      print_scl(G, C, cached_scl, CL, VERBOSE);
+      return;
+    }
+  }
+  
+  STATS::phase("edges");
   InterfaceEdgeList IEL(C);
   if (VERBOSE>1) IEL.print(std::cout);
   
   CentralEdgePairList CEL(C);
   if (VERBOSE>1) CEL.print(std::cout);
   
-  std::vector<CentralPolygon> CP;
-  compute_central_polys(C, IEL, CP, LIMIT_CENTRAL_SIDES);
+  STATS::phase("polygons");
+  CentralPolygonList CP;
+  compute_central_polys(C, IEL, CP, LIMIT_CENTRAL_SIDES || COLUMN_GENERATION, 
+                        NUM_THREADS);
   if (VERBOSE > 1) {
     std::cout << "computed polys (" << CP.size() << ")\n"; std::cout.flush();
     print_central_polys(CP, std::cout, VERBOSE);
@@ -726,15 +1403,29 @@ void SCYLLA::scylla(int argc, char** argv) {
   
   Rational scl;
   std::vector<Rational> solution_vector(0);                           //run the LP
-  scylla_lp(C, IEL, CEL, CP, GT, GR, 
-            &scl, 
-            &solution_vector, 
-            solver,
-            WRITE_LP, LP_filename,
-            CL,
-            VERBOSE,
-            LP_VERBOSE); 
+  if (COLUMN_GENERATION) {
+    scylla_lp_column_generation(C, IEL, CEL, CP, GT, GR, 
+                                &scl, 
+                                &solution_vector, 
+                                solver,
+                                VERBOSE,
+                                LP_VERBOSE);
+  } else {
+    //cl is an integer program, so an averaged solution is no good to it
+    ChainSymmetry S(C, (USE_SYMMETRY && !CL && !WRITE_LP ? SCYLLA_MAX_SYMMETRIES : 1));
+    scylla_lp(C, IEL, CEL, CP, GT, GR, 
+              &scl, 
+              &solution_vector, 
+              NULL, NULL, 
+              solver,
+              WRITE_LP, LP_filename,
+              CL,
+              VERBOSE,
+              LP_VERBOSE,
+              &S); 
+  }
   
+  STATS::phase("output");
   if (WRITE_LP) {
     std::cout << "Wrote linear program\n";
     return;
@@ -747,14 +1438,11 @@ void SCYLLA::scylla(int argc, char** argv) {
   if (CL) {
     scl = scl + Rational(1,2);
   }
-  if (VERBOSE>0) {
-    if (CL) {
-      std::cout << "cl_{" << G.short_rep() << "}(" << C << ") = " << scl << " = " << scl.get_d() << "\n";
-    } else {
-      std::cout << "scl_{" << G.short_rep() << "}( " << C << ") = " << scl << " = " << scl.get_d() << "\n";    //output the answer
-    } 
-  } else {
-    std::cout << scl.get_d() << "\n";
+  print_scl(G, C, scl, CL, VERBOSE);
+  
+  if (cache_key != "") {
+    SCLCACHE::store(cache_key, scl, solver, 
+                    std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count());
   }
   
   if (WRITE_FATGRAPH) {
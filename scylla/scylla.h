@@ -1,8 +1,12 @@
 #ifndef scylla_H
 #define scylla_H
 #include <vector>
+#include <string>
 #include "scylla_classes.h"
 
+//the most symmetries of a chain used to shrink the LP
+#define SCYLLA_MAX_SYMMETRIES 64
+
 namespace SCYLLA {
   
 void compute_group_teeth_and_rectangles(Chain &C,
@@ -11,10 +15,11 @@ void compute_group_teeth_and_rectangles(Chain &C,
   
   void compute_central_polys(Chain &C,
                              InterfaceEdgeList &IEL, 
-                             std::vector<CentralPolygon> &CP,
-                             bool limit_central_sides);
+                             CentralPolygonList &CP,
+                             bool limit_central_sides,
+                             int num_threads);
   
-  void print_central_polys(std::vector<CentralPolygon> &CP, 
+  void print_central_polys(CentralPolygonList &CP, 
                                    std::ostream &os, 
                            int level);
   
@@ -27,7 +32,7 @@ void compute_group_teeth_and_rectangles(Chain &C,
                                   Chain& C,
                                   InterfaceEdgeList& IEL,
                                   CentralEdgePairList &CEL, 
-                                  std::vector<CentralPolygon> &CP,
+                                  CentralPolygonList &CP,
                                   std::vector<GroupTooth> &GT,
                                   std::vector<GroupRectangle> &GR,
                                   std::vector<Rational>& solution_vector,
@@ -37,20 +42,38 @@ void compute_group_teeth_and_rectangles(Chain &C,
   void scylla_lp(Chain& C, 
                          InterfaceEdgeList &IEL,
                          CentralEdgePairList &CEL, 
-                         std::vector<CentralPolygon> &CP,
+                         CentralPolygonList &CP,
                          std::vector<GroupTooth> &GT,
                          std::vector<GroupRectangle> &GR,
                          Rational* scl, 
                          std::vector<Rational>* solution_vector, 
+                         std::vector<Rational>* dual_vector, 
+                         std::vector<double>* double_dual_vector, 
                          SparseLPSolver solver, 
                          bool WRITE_LP,
                          std::string LP_filename,
                          bool cl_not_scl,
                          int VERBOSE,
-                         int LP_VERBOSE);
+                         int LP_VERBOSE,
+                         ChainSymmetry* symmetry);
+  
+  void scylla_lp_column_generation(Chain& C, 
+                                   InterfaceEdgeList &IEL,
+                                   CentralEdgePairList &CEL, 
+                                   CentralPolygonList &CP,
+                                   std::vector<GroupTooth> &GT,
+                                   std::vector<GroupRectangle> &GR,
+                                   Rational* scl, 
+                                   std::vector<Rational>* solution_vector, 
+                                   SparseLPSolver solver, 
+                                   int VERBOSE,
+                                   int LP_VERBOSE);
   
   
 void scylla(int argc, char** argv);
 
+  //a key for the answer of ./scallop -cyclic <argv>; see scylla.cc
+  std::string canonical_command(int argc, char** argv);
+
 }
 #endif
\ No newline at end of file
@@ -3,6 +3,8 @@
 #include <string>
 #include <sstream>
 #include <utility>
+#include <algorithm>
+#include <set>
 
 #include <ctype.h>
 #include <stdlib.h>
@@ -190,18 +192,8 @@ void CyclicProduct::cyc_red(std::string &S) const {
   int current_start;
   int ord;
   std::vector<std::pair<char, int> > chunks(0);
-  i=0;
   //reduce the interior of the word
-  while (i < (int)S.size()-1) {
-    if (S[i] == swapCaseChar(S[i+1])) {
-      S.erase(i,2);
-      if (i > 0) {
-        i--;
-      }
-    } else {
-      i++;
-    }
-  }
+  red(S);
   
   //std::cout << "after reducing interior:" << S << "\n";
   
@@ -325,6 +317,196 @@ std::string CyclicProduct::short_rep() {
   return rep;
 }
     
+//Booth's algorithm: where the lexicographically least rotation of s 
+//starts, in linear time
+static int least_rotation_start(const std::vector<long>& s) {
+  int n = s.size();
+  if (n == 0) return 0;
+  std::vector<int> f(2*n, -1);
+  int k = 0;
+  for (int j=1; j<2*n; ++j) {
+    long sj = s[j%n];
+    int i = f[j-k-1];
+    while (i != -1 && sj != s[(k+i+1)%n]) {
+      if (sj < s[(k+i+1)%n]) {
+        k = j-i-1;
+      }
+      i = f[i];
+    }
+    if (sj != s[(k+i+1)%n]) {       //i == -1
+      if (sj < s[k%n]) {
+        k = j;
+      }
+      f[j-k] = -1;
+    } else {
+      f[j-k] = i+1;
+    }
+  }
+  return k%n;
+}
+
+//past this many automorphisms, only try the ones which invert every generator
+#define CANONICAL_MAX_TRANSFORMS (1<<14)
+
+std::string CyclicProduct::canonical_form(const std::vector<std::vector<int> >& words,
+                                          const std::vector<int>& weights) const {
+  int i,j,k;
+  int num_words = words.size();
+  
+  //each word as a cyclic list of chunks (gen, power), starting at a chunk
+  std::vector<std::vector<std::pair<int,int> > > chunks(num_words);
+  std::vector<bool> used(num_groups(), false);
+  long B = 1;                       //bigger than any power
+  for (i=0; i<num_words; ++i) {
+    const std::vector<int>& w = words[i];
+    int n = w.size();
+    int s = 0;
+    while (s < n && abs(w[s]) == abs(w[(s+n-1)%n])) s++;
+    if (s == n) s = 0;
+    j = 0;
+    while (j < n) {
+      int g = abs(w[(s+j)%n])-1;
+      int p = 0;
+      while (j < n && abs(w[(s+j)%n])-1 == g) {
+        p += (w[(s+j)%n] < 0 ? -1 : 1);
+        j++;
+      }
+      chunks[i].push_back(std::make_pair(g, p));
+      used[g] = true;
+      B = std::max(B, (long)abs(p)+1);
+    }
+  }
+  
+  //the generators which appear, by order; these get the labels 0,1,...
+  //and an automorphism permutes the labels of generators of the same order
+  std::vector<std::pair<int,int> > by_order(0);
+  for (i=0; i<num_groups(); ++i) {
+    if (used[i]) {
+      by_order.push_back(std::make_pair(orders[i], i));
+      B = std::max(B, (long)orders[i]);
+    }
+  }
+  std::sort(by_order.begin(), by_order.end());
+  int u = by_order.size();
+  std::vector<int> position(num_groups(), -1);
+  for (k=0; k<u; ++k) {
+    position[by_order[k].second] = k;
+  }
+  std::vector<int> class_start(0);
+  std::vector<int> flippable(0);    //inverting an order 2 generator does nothing
+  double num_transforms = 2;
+  for (k=0; k<u; ++k) {
+    if (k == 0 || by_order[k].first != by_order[k-1].first) {
+      class_start.push_back(k);
+    }
+    num_transforms *= (k - class_start.back() + 1);
+    if (by_order[k].first != 2) {
+      flippable.push_back(k);
+      num_transforms *= 2;
+    }
+  }
+  class_start.push_back(u);
+  bool all_transforms = (num_transforms <= CANONICAL_MAX_TRANSFORMS);
+  
+  std::vector<int> label(u);
+  for (k=0; k<u; ++k) {
+    label[k] = k;
+  }
+  std::vector<int> sign(u);
+  std::vector<std::pair<std::vector<long>, int> > terms(num_words);
+  std::vector<std::pair<std::vector<long>, int> > T(0);
+  std::vector<std::pair<std::vector<long>, int> > best(0);
+  bool found = false;
+  std::vector<long> w(0);
+  
+  while (true) {
+    int num_masks = (all_transforms ? (1 << flippable.size()) : 2);
+    for (int mask=0; mask<num_masks; ++mask) {
+      for (k=0; k<u; ++k) {
+        sign[k] = 1;
+      }
+      for (k=0; k<(int)flippable.size(); ++k) {
+        if (all_transforms ? ((mask >> k) & 1) : mask) {
+          sign[flippable[k]] = -1;
+        }
+      }
+      for (int reverse=0; reverse<2; ++reverse) {
+        for (i=0; i<num_words; ++i) {
+          w.resize(0);
+          for (j=0; j<(int)chunks[i].size(); ++j) {
+            k = position[chunks[i][j].first];
+            int p = chunks[i][j].second * sign[k] * (reverse ? -1 : 1);
+            int ord = by_order[k].first;
+            if (ord != 0) {
+              p = ((p % ord) + ord) % ord;
+            }
+            w.push_back(label[k]*2*B + p + B);
+          }
+          if (reverse) {
+            std::reverse(w.begin(), w.end());
+          }
+          int start = least_rotation_start(w);
+          terms[i].first.assign(w.begin()+start, w.end());
+          terms[i].first.insert(terms[i].first.end(), w.begin(), w.begin()+start);
+          terms[i].second = weights[i];
+        }
+        std::sort(terms.begin(), terms.end());
+        T.resize(0);
+        for (i=0; i<num_words; ++i) {
+          if ((int)T.size() > 0 && T.back().first == terms[i].first) {
+            T.back().second += terms[i].second;
+          } else {
+            T.push_back(terms[i]);
+          }
+          if (T.back().second == 0) {
+            T.pop_back();
+          }
+        }
+        if (!found || T < best) {
+          best = T;
+          found = true;
+        }
+      }
+    }
+    //the next permutation of the labels within each order
+    if (!all_transforms) break;
+    int c = 0;
+    while (c < (int)class_start.size()-1 
+           && !std::next_permutation(label.begin()+class_start[c], 
+                                     label.begin()+class_start[c+1])) {
+      c++;
+    }
+    if (c == (int)class_start.size()-1) break;
+  }
+  
+  //write it out like the input
+  std::ostringstream out;
+  bool letters = (u <= 26);
+  if (!letters) out << "G";
+  for (k=0; k<u; ++k) {
+    if (letters) {
+      out << (char)('a'+k) << by_order[k].first;
+    } else {
+      out << (k > 0 ? "," : "") << by_order[k].first;
+    }
+  }
+  for (i=0; i<(int)best.size(); ++i) {
+    out << " " << (letters ? "" : "w") << best[i].second;
+    for (j=0; j<(int)best[i].first.size(); ++j) {
+      long l = best[i].first[j] / (2*B);
+      long p = best[i].first[j] % (2*B) - B;
+      for (int e=0; e<abs(p); ++e) {
+        if (letters) {
+          out << (char)(p < 0 ? 'A'+l : 'a'+l);
+        } else {
+          out << "," << (p < 0 ? -(l+1) : l+1);
+        }
+      }
+    }
+  }
+  return out.str();
+}
+    
 std::ostream& SCYLLA::operator<<(std::ostream &os, const CyclicProduct &G) {
   int i;
   int len = G.orders.size();
@@ -536,6 +718,19 @@ void Chain::print_chunks(std::ostream &os) {
 }
 */
 
+std::string Chain::canonical_form(void) const {
+  if (raw) {
+    return G->canonical_form(raw_words, weights);
+  }
+  std::vector<std::vector<int> > W(words.size());
+  for (int i=0; i<(int)words.size(); ++i) {
+    for (int j=0; j<(int)words[i].size(); ++j) {
+      W[i].push_back((isupper(words[i][j]) ? -1 : 1) * (G->gen_index(words[i][j])+1));
+    }
+  }
+  return G->canonical_form(W, weights);
+}
+
 void Chain::print_letters(std::ostream &os) const {
   int i;
   for (i=0; i<(int)chain_letters.size(); i++) {
@@ -578,6 +773,118 @@ std::ostream& SCYLLA::operator<<(std::ostream &os, const Chain &C) {
 
 
 
+/*****************************************************************************
+ * symmetries of a chain
+ * ***************************************************************************/
+//is letter i of word v (shifted by t) the same as letter i of word w, for all i?
+static bool same_word_shifted(Chain &C, std::vector<int> &word_start, int v, int w, int t) {
+  int len = word_start[v+1] - word_start[v];
+  if (word_start[w+1] - word_start[w] != len) return false;
+  for (int i=0; i<len; i++) {
+    const ChainLetter &a = C.chain_letters[word_start[v] + (i+t)%len];
+    const ChainLetter &b = C.chain_letters[word_start[w] + i];
+    if (a.letter != b.letter || a.raw_letter != b.raw_letter) return false;
+  }
+  return true;
+}
+
+//the group generated by gens, or false if it has more than max_size elements
+static bool generate_group(std::vector<std::vector<int> > &gens, 
+                           int n,
+                           int max_size,
+                           std::vector<std::vector<int> > &group) {
+  std::set<std::vector<int> > seen;
+  group.assign(1, std::vector<int>(n));
+  for (int i=0; i<n; i++) {
+    group[0][i] = i;
+  }
+  seen.insert(group[0]);
+  for (int e=0; e<(int)group.size(); e++) {
+    for (int g=0; g<(int)gens.size(); g++) {
+      std::vector<int> p(n);
+      for (int i=0; i<n; i++) {
+        p[i] = gens[g][group[e][i]];
+      }
+      if (seen.insert(p).second) {
+        if ((int)group.size() == max_size) return false;
+        group.push_back(p);
+      }
+    }
+  }
+  return true;
+}
+
+ChainSymmetry::ChainSymmetry(Chain &C, int max_size) {
+  int i,v,w,t;
+  int n = C.num_letters();
+  int num_words = C.num_words();
+  std::vector<int> word_start(num_words+1, 0);
+  for (i=0; i<n; i++) {
+    word_start[C.chain_letters[i].word+1]++;
+  }
+  for (w=0; w<num_words; w++) {
+    word_start[w+1] += word_start[w];
+  }
+  
+  //the generators: the smallest rotation of each word which fixes it, and 
+  //a map from each word to the next one which is a rotation of it
+  std::vector<std::vector<int> > candidates(0);
+  std::vector<int> identity(n);
+  for (i=0; i<n; i++) {
+    identity[i] = i;
+  }
+  for (w=0; w<num_words; w++) {
+    int len = word_start[w+1] - word_start[w];
+    for (t=1; t<len; t++) {
+      if (len % t == 0 && same_word_shifted(C, word_start, w, w, t)) {
+        candidates.push_back(identity);
+        for (i=0; i<len; i++) {
+          candidates.back()[word_start[w]+i] = word_start[w] + (i+t)%len;
+        }
+        break;
+      }
+    }
+  }
+  std::vector<bool> matched(num_words, false);
+  for (v=0; v<num_words; v++) {
+    int len = word_start[v+1] - word_start[v];
+    for (w=v+1; w<num_words && !matched[v]; w++) {
+      if (matched[w] || C.weights[w] != C.weights[v]) continue;
+      for (t=0; t<len; t++) {
+        if (same_word_shifted(C, word_start, v, w, t)) {
+          //letter i of w goes to letter i+t of v, and back
+          candidates.push_back(identity);
+          for (i=0; i<len; i++) {
+            candidates.back()[word_start[w]+i] = word_start[v] + (i+t)%len;
+            candidates.back()[word_start[v] + (i+t)%len] = word_start[w]+i;
+          }
+          matched[v] = true;
+          break;
+        }
+      }
+    }
+  }
+  
+  //take as many of them as fit
+  std::vector<std::vector<int> > gens(0);
+  std::vector<std::vector<int> > group(0);
+  perms.assign(1, identity);
+  for (i=0; i<(int)candidates.size(); i++) {
+    gens.push_back(candidates[i]);
+    if (generate_group(gens, n, max_size, group)) {
+      perms = group;
+    } else {
+      gens.pop_back();
+    }
+  }
+}
+
+int ChainSymmetry::size() const {
+  return perms.size();
+}
+
+
+
 
 /****************************************************************************
  * make a list of all the central edges
@@ -585,8 +892,10 @@ std::ostream& SCYLLA::operator<<(std::ostream &os, const Chain &C) {
  * the edge is the letter just before it, and the letter just after
  ****************************************************************************/
 CentralEdgePairList::CentralEdgePairList() {
+  num_letters = 0;
   edge_pairs.resize(0);
   edge_pairs_beginning_with.resize(0);
+  index_table.resize(0);
 }
 
 CentralEdgePairList::CentralEdgePairList(Chain &C) {
@@ -596,6 +905,7 @@ CentralEdgePairList::CentralEdgePairList(Chain &C) {
   num_letters = C.num_letters();
   edge_pairs.resize(0);
   edge_pairs_beginning_with.resize(num_letters);
+  index_table = std::vector<int>(num_letters*num_letters, -1);
   for (i=0; i<num_letters; i++) {
     edge_pairs_beginning_with[i].resize(0);
     temp_central_edge_pair.first = i;
@@ -607,6 +917,7 @@ CentralEdgePairList::CentralEdgePairList(Chain &C) {
       temp_central_edge_pair.last = j;
       edge_pairs.push_back(temp_central_edge_pair);
       edge_pairs_beginning_with[i].push_back(edge_pairs.size()-1);
+      index_table[i*num_letters + j] = edge_pairs.size()-1;
     }
   }
 }
@@ -616,24 +927,15 @@ CentralEdgePairList::CentralEdgePairList(Chain &C) {
 //this returns ind+1
 //otherwise, it returns -(ind+1)
 int CentralEdgePairList::get_index(int a, int b) {
-  int i;
   int bm1 = my_chain->prev_letter(b); // sub_1_mod(b, num_letters);
   int ap1 = my_chain->next_letter(a);
   //std::cout << "Getting index of " << a << ", " << b << "\n";
+  //a missing pair is -1 in the table, so it comes out as 0, which is bad
   if (bm1 > a) {
-    for (i=0; i<(int)edge_pairs_beginning_with[a].size(); i++) {
-      if (edge_pairs[edge_pairs_beginning_with[a][i]].last == b) {
-        return edge_pairs_beginning_with[a][i]+1;
-      }
-    }
+    return index_table[a*num_letters + b]+1;
   } else {
-    for (i=0; i<(int)edge_pairs_beginning_with[bm1].size(); i++) {
-      if (edge_pairs[edge_pairs_beginning_with[bm1][i]].last == ap1) {
-        return -(edge_pairs_beginning_with[bm1][i]+1);
-      }
-    }
+    return -(index_table[bm1*num_letters + ap1]+1);
   }
-  return 0;  //this is bad
 }
 
 CentralEdgePair CentralEdgePairList::operator[](int index) {
@@ -663,8 +965,10 @@ int CentralEdgePairList::size() {
  * these are from the POLYGON's PERSPECTIVE
  ****************************************************************************/
 InterfaceEdgeList::InterfaceEdgeList() {
+  num_letters = 0;
   edges.resize(0);
   edges_beginning_with.resize(0);
+  index_table.resize(0);
 }
 
 InterfaceEdgeList::InterfaceEdgeList(Chain &C) {
@@ -672,8 +976,9 @@ InterfaceEdgeList::InterfaceEdgeList(Chain &C) {
   int num_groups = (C.G)->num_groups();
   InterfaceEdge temp_interface_edge;
   
+  num_letters = C.num_letters();
   edges.resize(0);
-  edges_beginning_with.resize(C.num_letters());
+  edges_beginning_with.resize(num_letters);
   
   for (i=0; i<num_groups; i++) {
     
@@ -719,26 +1024,24 @@ InterfaceEdgeList::InterfaceEdgeList(Chain &C) {
       }
     }
   }
+  
+  //the edges are already listed by first letter, so we only need to 
+  //fill in the table from those lists
+  index_table = std::vector<int>(num_letters*num_letters, -1);
+  for (i=0; i<num_letters; i++) {
+    for (j=(int)edges_beginning_with[i].size()-1; j>=0; j--) {
+      k = edges_beginning_with[i][j];
+      index_table[i*num_letters + edges[k].last] = k;
+    }
+  }
 }
 
 int InterfaceEdgeList::get_index_from_poly_side(int a, int b) {
-  int i;
-  for (i=0; i<(int)edges_beginning_with[a].size(); i++) {
-    if (edges[edges_beginning_with[a][i]].last == b) {
-      return edges_beginning_with[a][i];
-    }
-  }
-  return -1;
+  return index_table[a*num_letters + b];
 }
 
 int InterfaceEdgeList::get_index_from_group_side(int a, int b) {
-  int i;
-  for (i=0; i<(int)edges_beginning_with[b].size(); i++) {
-    if (edges[edges_beginning_with[b][i]].last == a) {
-      return edges_beginning_with[b][i];
-    }
-  }
-  return -1;
+  return index_table[b*num_letters + a];
 }
 
 InterfaceEdge InterfaceEdgeList::operator[](int index) {
@@ -762,22 +1065,26 @@ int InterfaceEdgeList::size() {
 /*****************************************************************************
  Central polygons
  *****************************************************************************/
+bool CentralPolygon::is_interface(int j) const {
+  return (interface >> j) & 1;
+}
+
 int CentralPolygon::chi_times_2() {
-  return 2 - (int)edges.size();
+  return 2 - num_sides;
 }
 
-void CentralPolygon::compute_ia_etc_for_edges(int col, 
-                                              Chain &C,
-                                              InterfaceEdgeList &IEL,
-                                              CentralEdgePairList &CEL,
-                                              SparseLP& LP) {
+//the rows and values of the LP column for this polygon (with any 
+//repeated rows combined)
+void CentralPolygon::compute_column(Chain &C,
+                                    InterfaceEdgeList &IEL,
+                                    CentralEdgePairList &CEL,
+                                    std::vector<int> &rows,
+                                    std::vector<int> &vals) {
   int i,j,row,val;
-  int num_sides = (int)edges.size();
-  std::vector<int> temp_ia(0);
-  std::vector<int> temp_ja(0);
-  std::vector<int> temp_ar(0);
+  rows.resize(0);
+  vals.resize(0);
   for (j=0; j<num_sides; j++) {
-    if (interface[j]) {
+    if (is_interface(j)) {
       row = IEL.get_index_from_poly_side(edges[j].first, edges[j].second);
       val = 1;
     } else {
@@ -792,31 +1099,41 @@ void CentralPolygon::compute_ia_etc_for_edges(int col,
         val = 1;
       }
     }
-    for (i=0; i<(int)temp_ia.size(); ++i) {
-      if (temp_ia[i] == row && temp_ja[i] == col) {
-        temp_ar[i] += val;
+    for (i=0; i<(int)rows.size(); ++i) {
+      if (rows[i] == row) {
+        vals[i] += val;
         break;
       }
     }
-    if (i==(int)temp_ia.size()) {
-      temp_ia.push_back(row);
-      temp_ja.push_back(col);
-      temp_ar.push_back(val);
+    if (i==(int)rows.size()) {
+      rows.push_back(row);
+      vals.push_back(val);
     }
   }
-  for (i=0; i<(int)temp_ia.size(); ++i) {
-    LP.add_entry(temp_ia[i], temp_ja[i], temp_ar[i]);
+}
+
+void CentralPolygon::compute_ia_etc_for_edges(int col, 
+                                              Chain &C,
+                                              InterfaceEdgeList &IEL,
+                                              CentralEdgePairList &CEL,
+                                              SparseLP& LP) {
+  int i;
+  std::vector<int> rows(0);
+  std::vector<int> vals(0);
+  compute_column(C, IEL, CEL, rows, vals);
+  for (i=0; i<(int)rows.size(); ++i) {
+    LP.add_entry(rows[i], col, vals[i]);
   }
 }  
   
   
 
-std::ostream& SCYLLA::operator<<(std::ostream &os, CentralPolygon &CP) {
+std::ostream& SCYLLA::operator<<(std::ostream &os, const CentralPolygon &CP) {
   int j;
   os << "CP: ";
-  for (j=0; j<(int)CP.edges.size(); j++) {
+  for (j=0; j<CP.num_sides; j++) {
     os << "(" << CP.edges[j].first << ", " << CP.edges[j].second << ")";
-    if (CP.interface[j]) {
+    if (CP.is_interface(j)) {
       os << "i";
     } else {
       os << "c";
@@ -827,6 +1144,54 @@ std::ostream& SCYLLA::operator<<(std::ostream &os, CentralPolygon &CP) {
 }
 
 
+int CentralPolygonList::size() const {
+  return (int)num_sides.size();
+}
+
+void CentralPolygonList::clear() {
+  first.resize(0);
+  last.resize(0);
+  num_sides.resize(0);
+  interface.resize(0);
+}
+
+void CentralPolygonList::reserve(int n) {
+  first.reserve(3*n);
+  last.reserve(3*n);
+  num_sides.reserve(n);
+  interface.reserve(n);
+}
+
+//unused sides of a bigon are stored as -1
+void CentralPolygonList::push_back(const CentralPolygon &P) {
+  int j;
+  for (j=0; j<3; j++) {
+    first.push_back(j < P.num_sides ? P.edges[j].first : -1);
+    last.push_back(j < P.num_sides ? P.edges[j].second : -1);
+  }
+  num_sides.push_back((unsigned char)P.num_sides);
+  interface.push_back(P.interface);
+}
+
+void CentralPolygonList::append(const CentralPolygonList &other) {
+  first.insert(first.end(), other.first.begin(), other.first.end());
+  last.insert(last.end(), other.last.begin(), other.last.end());
+  num_sides.insert(num_sides.end(), other.num_sides.begin(), other.num_sides.end());
+  interface.insert(interface.end(), other.interface.begin(), other.interface.end());
+}
+
+CentralPolygon CentralPolygonList::operator[](int index) const {
+  int j;
+  CentralPolygon P;
+  P.num_sides = num_sides[index];
+  P.interface = interface[index];
+  for (j=0; j<3; j++) {
+    P.edges[j] = std::make_pair(first[3*index+j], last[3*index+j]);
+  }
+  return P;
+}
+
+
 /****************************************************************************
  group tooth
  ****************************************************************************/
@@ -839,22 +1204,23 @@ double GroupTooth::chi_times_2(Chain &C) {
   }
 }
 
-void GroupTooth::compute_ia_etc_for_edges(int offset, 
-                                          Chain &C,
-                                          InterfaceEdgeList &IEL, 
-                                          std::vector<std::vector<std::vector<int> > > &group_teeth_rows, 
-                                          SparseLP& LP) {
-  int row;
-  int col = offset;
+//the rows and values of the LP column for this tooth, except for the 
+//word rows
+void GroupTooth::compute_edge_column(Chain &C,
+                                     InterfaceEdgeList &IEL, 
+                                     std::vector<std::vector<std::vector<int> > > &group_teeth_rows, 
+                                     std::vector<int> &rows,
+                                     std::vector<int> &vals) {
   int row1_offset, row2_offset;
   ChainLetter L1, L2, baseL;
+  rows.resize(0);
+  vals.resize(0);
   
   //do the interface edge
   if (C.next_letter(first) != last) { //only do it if it's not a dummy edge
-    row = IEL.get_index_from_group_side(first, last);
-    LP.add_entry(row, col, -1);
+    rows.push_back(IEL.get_index_from_group_side(first, last));
+    vals.push_back(-1);
   }
-  //std::cout << "Pushed interface " << row+1 << "," << col+1 << ",-1\n";
 
   //now do the group teeth edges
   L1 = C.chain_letters[first];
@@ -868,30 +1234,30 @@ void GroupTooth::compute_ia_etc_for_edges(int offset,
     row1_offset = group_teeth_rows[L1.group]
                                   [L1.index_in_group_reg_inv_list]
                                   [baseL.index_in_group_reg_inv_list];
-    row = row1_offset + (position-1);
-    LP.add_entry(row, col, -1);
-    //ia.push_back(row+1);
-    //ja.push_back(col+1);
-    //ar.push_back(-1);
-    //std::cout << "Compute row1_offset = " << row1_offset << 
-    //"  so row+1 = " << row+1 << "\n";
-    //std::cout << "Pushed tooth edge " << row+1 << "," << col+1 << ",-1\n";
-    
+    rows.push_back(row1_offset + (position-1));
+    vals.push_back(-1);
   }
   if (position < (C.G)->index_order(group_index)-1) {
     row2_offset = group_teeth_rows[L2.group]
                                   [L2.index_in_group_reg_inv_list]
                                   [baseL.index_in_group_reg_inv_list];
-    row = row2_offset + position;
-    LP.add_entry(row, col, 1);
-    //ia.push_back(row+1);
-    //ja.push_back(col+1);
-    //ar.push_back(1); 
-    //std::cout << "Compute row2_offset = " << row2_offset << 
-    //"  so row+1 = " << row+1 << "\n";
-    //std::cout << "Pushed tooth edge " << row+1 << "," << col+1 << ",1\n";
+    rows.push_back(row2_offset + position);
+    vals.push_back(1);
   } 
 }
+
+void GroupTooth::compute_ia_etc_for_edges(int offset, 
+                                          Chain &C,
+                                          InterfaceEdgeList &IEL, 
+                                          std::vector<std::vector<std::vector<int> > > &group_teeth_rows, 
+                                          SparseLP& LP) {
+  std::vector<int> rows(0);
+  std::vector<int> vals(0);
+  compute_edge_column(C, IEL, group_teeth_rows, rows, vals);
+  for (int i=0; i<(int)rows.size(); ++i) {
+    LP.add_entry(rows[i], offset, vals[i]);
+  }
+}
   
 
 void GroupTooth::compute_ia_etc_for_words(int offset, 
@@ -922,23 +1288,28 @@ std::ostream& SCYLLA::operator<<(std::ostream &os, GroupTooth &GT) {
 /****************************************************************************
  group rectangle
  ****************************************************************************/
+//the rows and values of the LP column for this rectangle, except for 
+//the word rows
+void GroupRectangle::compute_edge_column(InterfaceEdgeList &IEL,
+                                         std::vector<int> &rows,
+                                         std::vector<int> &vals) {
+  rows.resize(2);
+  vals.resize(2);
+  rows[0] = IEL.get_index_from_group_side(first, last);
+  vals[0] = -1;
+  rows[1] = IEL.get_index_from_group_side(last, first);
+  vals[1] = -1;
+}
+
 void GroupRectangle::compute_ia_etc_for_edges(int col, 
                                               InterfaceEdgeList &IEL,
                                               SparseLP& LP) {
-  int row;
-  row = IEL.get_index_from_group_side(first, last);
-  LP.add_entry(row, col, -1);
-  //ia.push_back(row+1);
-  //ja.push_back(col+1);
-  //ar.push_back(-1);
-  //std::cout << "Pushed " << row+1 << " " << col+1 << " " << -1 << "\n";
-
-  row = IEL.get_index_from_group_side(last, first);
-  LP.add_entry(row, col, -1);
-  //ia.push_back(row+1);
-  //ja.push_back(col+1);
-  //ar.push_back(-1);
-  //std::cout << "Pushed " << row+1 << " " << col+1 << " " << -1 << "\n";
+  std::vector<int> rows(0);
+  std::vector<int> vals(0);
+  compute_edge_column(IEL, rows, vals);
+  for (int i=0; i<(int)rows.size(); ++i) {
+    LP.add_entry(rows[i], col, vals[i]);
+  }
 }
 
 void GroupRectangle::compute_ia_etc_for_words(int offset, 
@@ -47,6 +47,16 @@ struct CyclicProduct {
   std::vector<int> orders;
   
   std::string short_rep();
+
+  //the least chain equivalent to the given one (cyclically reduced words 
+  //of signed 1-based gen indices) under rotating, reordering and merging 
+  //its words, automorphisms of the group which permute generators of the 
+  //same order and invert generators, and inverting the whole chain; 
+  //generators which don't appear are dropped.  scl and cl are the same for 
+  //all of these, so this is a key for the answer.  It's returned as the 
+  //arguments which would compute it, e.g. "a0b0 1abAB"
+  std::string canonical_form(const std::vector<std::vector<int> >& words,
+                             const std::vector<int>& weights) const;
     
 };
 std::ostream &operator<<(std::ostream &os, const CyclicProduct &G);
@@ -66,6 +76,7 @@ struct Chain {
   void print_chunks(std::ostream &os) const;
   void print_letters(std::ostream &os) const;
   void print_group_letters(std::ostream &os) const;
+  std::string canonical_form(void) const;      //see CyclicProduct::canonical_form
   
   CyclicProduct* G;
   bool raw;
@@ -82,6 +93,22 @@ struct Chain {
 std::ostream &operator<<(std::ostream &os, const Chain &C);
 
 
+/*****************************************************************************
+ * the permutations of the letters of a chain which preserve the letters, 
+ * next_letter and the weights: rotating a word w^n by |w|, and carrying 
+ * one copy of a word (up to rotation) to another.  These act on the 
+ * polygons and on the rows of the LP.  perms[h][i] is the image of 
+ * letter i under symmetry h, and perms[0] is the identity.  If all of 
+ * them would be more than max_size, it's a subgroup
+ * ***************************************************************************/
+struct ChainSymmetry {
+  ChainSymmetry(Chain &C, int max_size);
+  int size() const;
+  
+  std::vector<std::vector<int> > perms;
+};
+
+
 /****************************************************************************
  * an edge pair which can join central polygons 
  * Note this pair is edges (i,j) and (j-1,i+1)
@@ -108,6 +135,7 @@ struct CentralEdgePairList {
   Chain* my_chain;;
   std::vector<CentralEdgePair> edge_pairs;
   std::vector<std::vector<int> > edge_pairs_beginning_with;
+  std::vector<int> index_table;     //index_table[a*num_letters+b] is the index of (a,b), or -1
 };
 
 
@@ -132,8 +160,10 @@ struct InterfaceEdgeList {
   void print(std::ostream &os);
   int size();
   
+  int num_letters;
   std::vector<InterfaceEdge> edges;
   std::vector<std::vector<int> > edges_beginning_with;
+  std::vector<int> index_table;     //index_table[a*num_letters+b] is the index of (a,b), or -1
 };
 
 
@@ -142,9 +172,16 @@ struct InterfaceEdgeList {
  * a central polygon  (this is a list of interface and polygon edges)
  * ***************************************************************************/
 struct CentralPolygon {
-  std::vector<std::pair<int, int> > edges; //these record the first and second letters in the edge pair
-  std::vector<bool> interface;   //this records whether the edge is an interface edge
+  int num_sides;                      //2 or 3
+  std::pair<int, int> edges[3];       //these record the first and second letters in the edge pair
+  unsigned char interface;            //bit j is set if edge j is an interface edge
+  bool is_interface(int j) const;
   int chi_times_2();
+  void compute_column(Chain &C,
+                      InterfaceEdgeList &IEL,
+                      CentralEdgePairList &CEL,
+                      std::vector<int> &rows,
+                      std::vector<int> &vals);
   void compute_ia_etc_for_edges(int col,
                                 Chain &C,
                                 InterfaceEdgeList &IEL,
@@ -152,7 +189,27 @@ struct CentralPolygon {
                                 SparseLP& LP);
 };
 
-std::ostream &operator<<(std::ostream &os, CentralPolygon &CP);
+std::ostream &operator<<(std::ostream &os, const CentralPolygon &CP);
+
+/*****************************************************************************
+ * all the central polygons, stored flat (there can be millions of them): 
+ * polygon i has num_sides[i] sides, side j is the edge 
+ * (first[3*i+j], last[3*i+j]), and it's an interface edge if bit j of 
+ * interface[i] is set.  operator[] unpacks a polygon
+ * ***************************************************************************/
+struct CentralPolygonList {
+  int size() const;
+  void clear();
+  void reserve(int n);
+  void push_back(const CentralPolygon &P);
+  void append(const CentralPolygonList &other);
+  CentralPolygon operator[](int index) const;
+  
+  std::vector<int> first;
+  std::vector<int> last;
+  std::vector<unsigned char> num_sides;
+  std::vector<unsigned char> interface;
+};
 
 /****************************************************************************
  * a group outside edge (these pair with the interface edges)
@@ -165,6 +222,11 @@ struct GroupTooth {
   int group_index;  //index of the group
   int base_letter;  //the base letter (as position in the chain)
   double chi_times_2(Chain &C);
+  void compute_edge_column(Chain &C,
+                           InterfaceEdgeList &IEL, 
+                           std::vector<std::vector<std::vector<int> > > &group_teeth_rows, 
+                           std::vector<int> &rows,
+                           std::vector<int> &vals);
   void compute_ia_etc_for_edges(int offset, 
                                 Chain &C,
                                 InterfaceEdgeList &IEL, 
@@ -187,6 +249,9 @@ struct GroupRectangle {
   int group_index;
   int first;            //the first letter of the rectangle (position in the chain)
   int last;             //the second letter of the rectangle
+  void compute_edge_column(InterfaceEdgeList &IEL,
+                           std::vector<int> &rows,
+                           std::vector<int> &vals);
   void compute_ia_etc_for_edges(int offset, 
                                 InterfaceEdgeList &IEL, 
                                 SparseLP& LP);
@@ -0,0 +1,193 @@
+#include <string>
+#include <vector>
+#include <iostream>
+#include <chrono>
+#include <sys/time.h>
+#include <sys/resource.h>
+
+#include "stats.h"
+
+
+struct StatsPhase {
+  std::string name;
+  double wall_seconds;
+  double cpu_seconds;
+  long peak_rss_kb;       //peak for the whole process, as of the end of the phase
+};
+
+struct StatsCounter {
+  std::string name;
+  long value;
+};
+
+//a phase which is entered more than once (e.g. solving several LPs)
+//accumulates into one entry, listed in order of first appearance
+static bool stats_on = false;
+static std::vector<StatsPhase> phases;
+static std::vector<StatsCounter> counters;
+static int current_phase = -1;
+static std::chrono::steady_clock::time_point stats_start;
+static double stats_start_cpu;
+static std::chrono::steady_clock::time_point phase_start;
+static double phase_start_cpu;
+
+static double cpu_seconds(void) {
+  struct rusage usage;
+  getrusage(RUSAGE_SELF, &usage);
+  return usage.ru_utime.tv_sec + usage.ru_stime.tv_sec
+         + 1e-6*(usage.ru_utime.tv_usec + usage.ru_stime.tv_usec);
+}
+
+static long peak_rss_kb(void) {
+  struct rusage usage;
+  getrusage(RUSAGE_SELF, &usage);
+#ifdef __APPLE__
+  return usage.ru_maxrss / 1024;    //bytes on OS X
+#else
+  return usage.ru_maxrss;
+#endif
+}
+
+static void write_json_string(std::ostream& os, const std::string& s) {
+  os << "\"";
+  for (int i=0; i<(int)s.size(); ++i) {
+    if (s[i] == '"' || s[i] == '\\') {
+      os << "\\";
+    }
+    os << s[i];
+  }
+  os << "\"";
+}
+
+void STATS::start(void) {
+  stats_on = true;
+  phases.resize(0);
+  counters.resize(0);
+  current_phase = -1;
+  stats_start = std::chrono::steady_clock::now();
+  stats_start_cpu = cpu_seconds();
+}
+
+void STATS::stop(void) {
+  end_phase();
+  stats_on = false;
+}
+
+bool STATS::enabled(void) {
+  return stats_on;
+}
+
+void STATS::phase(const std::string& name) {
+  int i;
+  if (!stats_on) {
+    return;
+  }
+  end_phase();
+  for (i=0; i<(int)phases.size(); ++i) {
+    if (phases[i].name == name) {
+      break;
+    }
+  }
+  if (i == (int)phases.size()) {
+    StatsPhase P;
+    P.name = name;
+    P.wall_seconds = 0;
+    P.cpu_seconds = 0;
+    P.peak_rss_kb = 0;
+    phases.push_back(P);
+  }
+  current_phase = i;
+  phase_start = std::chrono::steady_clock::now();
+  phase_start_cpu = cpu_seconds();
+}
+
+void STATS::end_phase(void) {
+  if (!stats_on || current_phase < 0) {
+    return;
+  }
+  StatsPhase& P = phases[current_phase];
+  P.wall_seconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - phase_start).count();
+  P.cpu_seconds += cpu_seconds() - phase_start_cpu;
+  P.peak_rss_kb = peak_rss_kb();
+  current_phase = -1;
+}
+
+void STATS::count(const std::string& name, long value) {
+  int i;
+  if (!stats_on) {
+    return;
+  }
+  for (i=0; i<(int)counters.size(); ++i) {
+    if (counters[i].name == name) {
+      counters[i].value = value;
+      return;
+    }
+  }
+  StatsCounter C;
+  C.name = name;
+  C.value = value;
+  counters.push_back(C);
+}
+
+void STATS::add(const std::string& name, long value) {
+  int i;
+  if (!stats_on) {
+    return;
+  }
+  for (i=0; i<(int)counters.size(); ++i) {
+    if (counters[i].name == name) {
+      counters[i].value += value;
+      return;
+    }
+  }
+  count(name, value);
+}
+
+void STATS::max(const std::string& name, long value) {
+  int i;
+  if (!stats_on) {
+    return;
+  }
+  for (i=0; i<(int)counters.size(); ++i) {
+    if (counters[i].name == name) {
+      if (counters[i].value < value) {
+        counters[i].value = value;
+      }
+      return;
+    }
+  }
+  count(name, value);
+}
+
+void STATS::phase_times(std::vector<std::string>& names, 
+                        std::vector<double>& wall_seconds) {
+  names.resize(phases.size());
+  wall_seconds.resize(phases.size());
+  for (int i=0; i<(int)phases.size(); ++i) {
+    names[i] = phases[i].name;
+    wall_seconds[i] = phases[i].wall_seconds;
+  }
+}
+
+void STATS::print_json(std::ostream& os) {
+  int i;
+  double total = std::chrono::duration<double>(std::chrono::steady_clock::now() - stats_start).count();
+  os << "{\"wall_seconds\": " << total
+     << ", \"cpu_seconds\": " << cpu_seconds() - stats_start_cpu
+     << ", \"peak_rss_kb\": " << peak_rss_kb()
+     << ", \"phases\": [";
+  for (i=0; i<(int)phases.size(); ++i) {
+    os << (i > 0 ? ", " : "") << "{\"name\": ";
+    write_json_string(os, phases[i].name);
+    os << ", \"wall_seconds\": " << phases[i].wall_seconds
+       << ", \"cpu_seconds\": " << phases[i].cpu_seconds
+       << ", \"peak_rss_kb\": " << phases[i].peak_rss_kb << "}";
+  }
+  os << "], \"counters\": {";
+  for (i=0; i<(int)counters.size(); ++i) {
+    os << (i > 0 ? ", " : "");
+    write_json_string(os, counters[i].name);
+    os << ": " << counters[i].value;
+  }
+  os << "}}\n";
+}
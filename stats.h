@@ -0,0 +1,25 @@
+#ifndef STATS_H
+#define STATS_H
+
+#include <string>
+#include <vector>
+#include <iostream>
+
+//wall time, cpu time and peak memory for each phase of a computation,
+//plus some counters (e.g. the size of the LP).  Nothing is recorded
+//unless start has been called (this is the -T option)
+namespace STATS {
+  void start(void);                                 //turn on recording, clearing anything recorded
+  void stop(void);                                  //turn it off again
+  bool enabled(void);
+  void phase(const std::string& name);              //end the current phase, and begin the named one
+  void end_phase(void);
+  void count(const std::string& name, long value);  //set a counter
+  void add(const std::string& name, long value);    //add to a counter
+  void max(const std::string& name, long value);    //raise a counter to value, if it's less
+  void print_json(std::ostream& os);                //everything, as one line of JSON
+  void phase_times(std::vector<std::string>& names,   //the wall time of each phase
+                   std::vector<double>& wall_seconds);
+}
+
+#endif
@@ -12,6 +12,9 @@
 #include <fstream>
 #include <string>
 #include <vector>
+#include <map>
+#include <algorithm>
+#include <unordered_set>
 #include <stdlib.h>
 #include <ctype.h>
 
@@ -20,6 +23,7 @@
 #include "../rational.h"
 #include "../word.h"
 #include "../lp.h"
+#include "../stats.h"
 
 
 
@@ -235,7 +239,9 @@ void free_vector(T & t) {
 
 
 /***************************************************************************
- a helper function to collect duplicates
+ a helper function to collect duplicates (the entries of a column in the 
+ same row are summed, in the order of their first appearance); the caller
+ keeps the accumulator, so that it can be reused from column to column
  ***************************************************************************/
 void TROLLOP::collect_dups_and_push(std::vector<int> &temp_ia,
                            std::vector<int> &temp_ja,
@@ -243,42 +249,19 @@ void TROLLOP::collect_dups_and_push(std::vector<int> &temp_ia,
                            std::vector<int> &ia,
                            std::vector<int> &ja,
                            std::vector<int> &ar,
+                           SparseAccumulator<int> &accumulator,
                            int VERBOSE) {
-  int j, k, temp;
-  if (VERBOSE < 4) {
-    for (j=0; j<(int)temp_ia.size(); j++) {
-      if (temp_ar[j] == 0) {
-        continue;
-      }
-      temp = 0;
-      for (k=0; k<(int)temp_ia.size(); k++) {
-        if (temp_ia[k] == temp_ia[j]) {
-          temp += temp_ar[k];
-          temp_ar[k] = 0;
-        }
-      }
-      ja.push_back(temp_ja[j]);
-      ia.push_back(temp_ia[j]);
-      ar.push_back(temp);
-    }
-  } else {
-    for (j=0; j<(int)temp_ia.size(); j++) {
-      if (temp_ar[j] == 0) {
-        continue;
-      }
-      temp = 0;
-      for (k=0; k<(int)temp_ia.size(); k++) {
-        if (temp_ia[k] == temp_ia[j]) {
-          temp += temp_ar[k];
-          temp_ar[k] = 0;
-        }
-      }
-      ja.push_back(temp_ja[j]);
-      ia.push_back(temp_ia[j]);
-      ar.push_back(temp);
-      std::cout << "Put " << temp_ia[j] << ", " << temp_ja[j] << ", " << temp << ".\n";
+  int j, k;
+  accumulator.merge(temp_ia, temp_ar);
+  for (k=0; k<(int)accumulator.first.size(); k++) {
+    j = accumulator.first[k];
+    ja.push_back(temp_ja[j]);
+    ia.push_back(temp_ia[j]);
+    ar.push_back(accumulator.sum[k]);
+    if (VERBOSE >= 4) {
+      std::cout << "Put " << temp_ia[j] << ", " << temp_ja[j] << ", " << accumulator.sum[k] << ".\n";
     }
-  }    
+  }
 }
 
 
@@ -308,6 +291,7 @@ void TROLLOP::write_lp(WordTable& WT,
   std::fstream outbFile;
   std::fstream outcFile;
   //these are all just for removing duplicates:
+  SparseAccumulator<int> accumulator;
   std::vector<int> temp_ia2(0);
 	std::vector<int> temp_ja2(0);
 	std::vector<int> temp_ar2(0); 
@@ -393,7 +377,7 @@ void TROLLOP::write_lp(WordTable& WT,
     temp_ja.push_back(i+1);
     temp_ar.push_back(1);
     collect_dups_and_push(temp_ia, temp_ja, temp_ar, 
-                          temp_ia2, temp_ja2, temp_ar2, VERBOSE);
+                          temp_ia2, temp_ja2, temp_ar2, accumulator, VERBOSE);
     for (j=0; j<(int)temp_ia2.size(); j++) {
       outAFile << temp_ia2[j] << " " << temp_ja2[j] << " " << temp_ar2[j] << "\n";
     }
@@ -465,7 +449,7 @@ void TROLLOP::write_lp(WordTable& WT,
       temp_ia.push_back(row_offset + row2 + 1);
       temp_ja.push_back(col_offset + i + 1);
       temp_ar.push_back(-1);
-      collect_dups_and_push(temp_ia, temp_ja, temp_ar, temp_ia2, temp_ja2, temp_ar2, VERBOSE);
+      collect_dups_and_push(temp_ia, temp_ja, temp_ar, temp_ia2, temp_ja2, temp_ar2, accumulator, VERBOSE);
       for (j=0; j<(int)temp_ia2.size(); j++) {
         outAFile << temp_ia2[j] << " " << temp_ja2[j] << " " << temp_ar2[j] << "\n";
       }
@@ -568,6 +552,8 @@ void TROLLOP::trollop_lp(WordTable& WT,
                 std::vector<int>& b,
                 Rational& ans,
                 std::vector<Rational>& solution_vector,
+                std::vector<Rational>* dual_vector,
+                std::vector<double>* double_dual_vector,
                 SparseLPSolver solver,
                 int VERBOSE,
                 int LP_VERBOSE) {
@@ -955,12 +941,341 @@ void TROLLOP::trollop_lp(WordTable& WT,
     //std::cout << "Created " << ia.size() << " nonzeroes on " << num_rows << " rows and " << num_cols << " columns\n";
   }
   
+  STATS::phase("solve");
   LP.solve(VERBOSE);
   
+  STATS::phase("recovery");
   LP.get_optimal_value(ans);
   LP.get_soln_vector(solution_vector);
+  if (dual_vector != NULL) {
+    LP.get_dual_vector(*dual_vector);
+  }
+  if (double_dual_vector != NULL) {
+    LP.get_dual_vector(*double_dual_vector);
+  }
   
+}
+
+
+/****************************************************************************
+ * delayed column generation (-G).  There are cubically many triangles in 
+ * the number of vertices, and almost all of them are zero in the optimum, 
+ * so the triangles are never all stored: we start with the ones whose 
+ * arcs are sides of rectangles, and then only add the ones with negative 
+ * reduced cost under the arc duals of the current LP, until there are 
+ * none.  The answer is the same as with all the triangles.
+ * ***************************************************************************/
+//add the triangle (side0-v0, side1-v1, side2-v2) to TR, unless it's there 
+//already; the triangles in TR are keyed by their three vertices, as 
+//positions side*num_verts + v.  Returns whether it was added
+static bool add_triangle(ArcPairList& AL, 
+                         int side0, int v0, int side1, int v1, int side2, int v2,
+                         std::vector<Triangle>& TR,
+                         std::unordered_set<long long>& in_TR) {
+  long long n = (long long)AL.num_copies * AL.num_verts;
+  long long key = ((long long)(side0*AL.num_verts + v0)*n 
+                   + (side1*AL.num_verts + v1))*n + (side2*AL.num_verts + v2);
+  if (in_TR.count(key) > 0) {
+    return false;
+  }
+  Triangle temp_t;
+  temp_t.v0 = v0; temp_t.v1 = v1; temp_t.v2 = v2;
+  temp_t.a0 = AL.index_of_arc(side0, v0, side1, v1);
+  temp_t.a1 = AL.index_of_arc(side1, v1, side2, v2);
+  temp_t.a2 = AL.index_of_arc(side2, v2, side0, v0);
+  TR.push_back(temp_t);
+  in_TR.insert(key);
+  return true;
+}
+
+//the dual of the arc from (sidea, a) to (sideb, b), in that direction
+template <typename T>
+static T arc_dual(ArcPairList& AL, std::vector<T>& duals, 
+                  int sidea, int a, int sideb, int b) {
+  int sign, index;
+  extract_signed_index(&sign, &index, AL.index_of_arc(sidea, a, sideb, b));
+  return (sign < 0 ? T(0) - duals[index] : duals[index]);
+}
+
+//add to TR the triangles, in the order of compute_triangles, which 
+//aren't there yet and have at least min_rect_arcs arcs which are 
+//sides of rectangles; returns how many were added
+static int add_seed_triangles(WordTable& WT, 
+                              ArcPairList& AL, 
+                              int num_copies,
+                              std::vector<bool>& on_rectangle,
+                              int min_rect_arcs,
+                              std::vector<Triangle>& TR,
+                              std::unordered_set<long long>& in_TR) {
+  int v0,v1,v2,a0,a1,a2;
+  int side0, side1, side2;
+  int sign, index, num_rect_arcs;
+  int num_added = 0;
+  for (side0=0; side0<num_copies; side0++) {
+    for (v0=0; v0<WT.num_verts; v0++) {
+      for (side1=0; side1<num_copies; side1++) {
+        for (v1 = v0+1; v1<WT.num_verts; v1++) {
+          a0 = AL.index_of_arc(side0, v0, side1, v1);
+          for (side2=0; side2<num_copies; side2++) {
+            for (v2 = v0+1; v2<WT.num_verts; v2++) {
+              if (v2 == v1) {
+                continue;
+              }
+              a1 = AL.index_of_arc(side1, v1, side2, v2);
+              a2 = AL.index_of_arc(side2, v2, side0, v0);
+              num_rect_arcs = 0;
+              extract_signed_index(&sign, &index, a0);
+              num_rect_arcs += (on_rectangle[index] ? 1 : 0);
+              extract_signed_index(&sign, &index, a1);
+              num_rect_arcs += (on_rectangle[index] ? 1 : 0);
+              extract_signed_index(&sign, &index, a2);
+              num_rect_arcs += (on_rectangle[index] ? 1 : 0);
+              if (num_rect_arcs < min_rect_arcs) {
+                continue;
+              }
+              if (add_triangle(AL, side0, v0, side1, v1, side2, v2, TR, in_TR)) {
+                num_added++;
+              }
+            }
+          }
+        }
+      }
+    }
+  }
+  return num_added;
+}
+
+//add to TR (up to TROLLOP_MAX_PRICED_TRIANGLES of) the triangles which 
+//aren't there yet and have negative reduced cost 1 - (sum of the arc 
+//duals around it).  For each first vertex, a second vertex is skipped 
+//when even the largest duals out of it and into the first vertex can't 
+//make the reduced cost negative; returns how many were added
+template <typename T>
+static int add_priced_triangles(WordTable& WT, 
+                                ArcPairList& AL, 
+                                int num_copies,
+                                std::vector<T>& duals,
+                                std::vector<Triangle>& TR,
+                                std::unordered_set<long long>& in_TR) {
+  int v0,v1,v2;
+  int side0, side1, side2;
+  int p, q;
+  int V = WT.num_verts;
+  int n = num_copies * V;
+  int num_added = 0;
+  
+  //max_out[p] is the largest dual of an arc out of p; max_in[p] into it
+  std::vector<T> max_out(n, T(0));
+  std::vector<T> max_in(n, T(0));
+  for (p=0; p<n; p++) {
+    bool first = true;
+    for (q=0; q<n; q++) {
+      if (p == q) {
+        continue;
+      }
+      T d = arc_dual(AL, duals, p/V, p%V, q/V, q%V);
+      if (first || d > max_out[p]) {
+        max_out[p] = d;
+      }
+      if (first || T(0) - d > max_in[p]) {
+        max_in[p] = T(0) - d;
+      }
+      first = false;
+    }
+  }
   
+  for (side0=0; side0<num_copies; side0++) {
+    for (v0=0; v0<V; v0++) {
+      for (side1=0; side1<num_copies; side1++) {
+        for (v1 = v0+1; v1<V; v1++) {
+          T d01 = arc_dual(AL, duals, side0, v0, side1, v1);
+          if (!is_negative(T(1) - d01 - max_out[side1*V + v1] - max_in[side0*V + v0])) {
+            continue;
+          }
+          for (side2=0; side2<num_copies; side2++) {
+            for (v2 = v0+1; v2<V; v2++) {
+              if (v2 == v1) {
+                continue;
+              }
+              T reduced_cost = T(1) - d01 
+                                    - arc_dual(AL, duals, side1, v1, side2, v2) 
+                                    - arc_dual(AL, duals, side2, v2, side0, v0);
+              if (!is_negative(reduced_cost)) {
+                continue;
+              }
+              if (!add_triangle(AL, side0, v0, side1, v1, side2, v2, TR, in_TR)) {
+                continue;
+              }
+              num_added++;
+              if (num_added == TROLLOP_MAX_PRICED_TRIANGLES) {
+                return num_added;
+              }
+            }
+          }
+        }
+      }
+    }
+  }
+  return num_added;
+}
+
+//for -ladder: a vertex of the last length (a word of length ell-2) lifts 
+//to the vertices of this length which start with it, and a triangle lifts 
+//to the triangles on the combinations of lifts of its vertices.  These 
+//are given as for the warm start of trollop_lp_column_generation
+static void lift_triangles(WordTable& WT, 
+                           std::vector<std::vector<std::string> >& support,
+                           std::vector<std::vector<int> >& lifted) {
+  std::map<std::string, std::vector<int> > lifts;
+  std::map<std::string, std::vector<int> >::iterator L[3];
+  std::string S;
+  int i, j, k, m;
+  for (i=0; i<WT.num_verts; i++) {
+    WT.get_word(S, WT.ell-1, i);
+    lifts[S.substr(0, S.size()-1)].push_back(i);
+  }
+  for (i=0; i<(int)support.size(); i++) {
+    for (m=0; m<3; m++) {
+      L[m] = lifts.find(support[i][m]);
+      if (L[m] == lifts.end()) {
+        break;
+      }
+    }
+    if (m < 3) {
+      continue;
+    }
+    for (j=0; j<(int)L[0]->second.size(); j++) {
+      for (k=0; k<(int)L[1]->second.size(); k++) {
+        for (m=0; m<(int)L[2]->second.size(); m++) {
+          std::vector<int> P(3);
+          P[0] = L[0]->second[j];
+          P[1] = L[1]->second[k];
+          P[2] = L[2]->second[m];
+          if (P[0] == P[1] || P[1] == P[2] || P[2] == P[0]) {
+            continue;
+          }
+          std::rotate(P.begin(), std::min_element(P.begin(), P.end()), P.end());
+          lifted.push_back(P);
+        }
+      }
+    }
+  }
+}
+
+//The seed is the triangles in warm_start (if it isn't NULL), each given 
+//by the positions side*num_verts + v of its vertices, the first having 
+//the smallest vertex, plus the triangles all of whose arcs are sides of 
+//rectangles; while the LP is infeasible, we allow triangles with fewer 
+//such arcs, down to all of them
+void TROLLOP::trollop_lp_column_generation(WordTable& WT, 
+                                           WVec& C, 
+                                           ArcPairList& AL, 
+                                           int num_copies,
+                                           std::vector<Triangle>& TR, 
+                                           std::vector<Rectangle>& RE, 
+                                           bool DO_SUP,
+                                           bool MAT_COMP,
+                                           bool MAT_SEPARATE_DOMAIN,
+                                           std::vector<std::vector<int> >& M,
+                                           std::vector<std::vector<int> >& N,
+                                           std::vector<int>& b,
+                                           Rational& ans,
+                                           std::vector<Rational>& solution_vector,
+                                           SparseLPSolver solver,
+                                           int VERBOSE,
+                                           int LP_VERBOSE,
+                                           std::vector<std::vector<int> >* warm_start) {
+  bool exact = gives_exact_duals(solver);
+  std::vector<Rational> duals(0);
+  std::vector<double> double_duals(0);
+  std::unordered_set<long long> in_TR;
+  std::vector<bool> on_rectangle(AL.num_arcs, false);
+  int sign, index;
+  int i, num_added;
+  int min_rect_arcs;
+  
+  for (i=0; i<(int)RE.size(); i++) {
+    extract_signed_index(&sign, &index, RE[i].a0);
+    on_rectangle[index] = true;
+    extract_signed_index(&sign, &index, RE[i].a1);
+    on_rectangle[index] = true;
+  }
+  
+  TR.resize(0);
+  if (warm_start != NULL) {
+    int V = WT.num_verts;
+    for (i=0; i<(int)warm_start->size(); i++) {
+      std::vector<int>& P = (*warm_start)[i];
+      add_triangle(AL, P[0]/V, P[0]%V, P[1]/V, P[1]%V, P[2]/V, P[2]%V, TR, in_TR);
+    }
+    if (VERBOSE > 1) {
+      std::cout << "Warm started with " << TR.size() << " triangles\n";
+    }
+  }
+  for (min_rect_arcs=3; min_rect_arcs>=0; min_rect_arcs--) {
+    STATS::phase("polygons");
+    num_added = add_seed_triangles(WT, AL, num_copies, on_rectangle, min_rect_arcs, TR, in_TR);
+    STATS::phase("lp_setup");
+    trollop_lp(WT, C, AL, num_copies, TR, RE, DO_SUP, MAT_COMP, MAT_SEPARATE_DOMAIN, M, N, b, 
+               ans, 
+               solution_vector, 
+               (exact ? &duals : NULL), 
+               (exact ? NULL : &double_duals), 
+               solver, 
+               VERBOSE, 
+               LP_VERBOSE);
+    if (VERBOSE > 1) {
+      std::cout << "Seeded with the triangles with at least " << min_rect_arcs 
+                << " rectangle arcs (" << TR.size() << "): ";
+      if (ans == -1) {
+        std::cout << "infeasible\n";
+      } else {
+        std::cout << ans << "\n";
+      }
+    }
+    if (!(ans == -1)) {
+      break;
+    }
+  }
+  if (ans == -1 || min_rect_arcs == 0) {
+    //infeasible even with all the triangles, or we already have them all
+    return;
+  }
+  
+  for (int round=0; ; ++round) {
+    STATS::phase("pricing");
+    if ((int)duals.size() == 0 && (int)double_duals.size() == 0) {
+      //without duals we can't price, so we add them all
+      num_added = add_seed_triangles(WT, AL, num_copies, on_rectangle, 0, TR, in_TR);
+    } else if (exact) {
+      num_added = add_priced_triangles(WT, AL, num_copies, duals, TR, in_TR);
+    } else {
+      num_added = add_priced_triangles(WT, AL, num_copies, double_duals, TR, in_TR);
+    }
+    if (VERBOSE > 1) {
+      std::cout << "Column generation round " << round << ": " 
+                << "value " << ans << "; added " << num_added 
+                << " triangles (now " << TR.size() << ")\n";
+      if ((int)duals.size() == 0 && (int)double_duals.size() == 0) {
+        std::cout << "(the solver gave no duals, so we added all of them)\n";
+      }
+    }
+    if (num_added == 0) {
+      break;
+    }
+    STATS::phase("lp_setup");
+    trollop_lp(WT, C, AL, num_copies, TR, RE, DO_SUP, MAT_COMP, MAT_SEPARATE_DOMAIN, M, N, b, 
+               ans, 
+               solution_vector, 
+               (exact ? &duals : NULL), 
+               (exact ? NULL : &double_duals), 
+               solver, 
+               VERBOSE, 
+               LP_VERBOSE);
+    if ((int)duals.size() == 0 && (int)double_duals.size() == 0) {
+      break;
+    }
+  }
 }
 
 
@@ -975,6 +1290,9 @@ int TROLLOP::trollop(int argc, char* argv[]) {
   bool OUTPUT_PROGRAM = false;
   bool MAT_COMP = false;
   bool MAT_SEPARATE_DOMAIN = false;
+  bool COLUMN_GENERATION = false;
+  bool LADDER = false;
+  int ladder_top = 0;
   SparseLPSolver solver = GLPK;
   int num_copies=1;
   
@@ -984,7 +1302,7 @@ int TROLLOP::trollop(int argc, char* argv[]) {
   std::string filename;
   
   if (argc < 2 || std::string(argv[1]) == "-h") {
-    std::cout << "usage: ./scallop -train [-h] [-v[n]] [-V] [-m<GLPK,GIPT,GUROBI,EXLP>] [-L filename] [-sup,-scl, [-dom] -mat M_file N_file b_file rank length] [-w] <length> <chain or list of words>\n";
+    std::cout << "usage: ./scallop -train [-h] [-v[n]] [-V] [-m<GLPK,GIPT,GUROBI,EXLP,HYBRID>] [-G] [-ladder L] [-L filename] [-sup,-scl, [-dom] -mat M_file N_file b_file rank length] [-w] <length> <chain or list of words>\n";
     std::cout << "\twhere <length gives the length of the words we want\n";
     std::cout << "\tand <chain...> is a chain OR, if -w, a list of words\n";
     std::cout << "\te.g. ./trollop 3 abABAbaB\n";
@@ -992,6 +1310,8 @@ int TROLLOP::trollop(int argc, char* argv[]) {
     std::cout << "\t-v[n]: verbose output (n=0,1,2,3); 0 gives quiet output\n";
     std::cout << "\t-V: verbose LP output\n";
     std::cout << "\t-m<method>: use the LP solver specified\n";
+    std::cout << "\t-G: don't compute all the triangles; add them by column generation\n";
+    std::cout << "\t-ladder L: compute every length from <length> up to L, starting each from the last (implies -G)\n";
     std::cout << "\t-L: output the linear program as a sparse matrix and two vectors to filename.A, .b, and .c\n";
     std::cout << "\t-sup: computes sup phi(C)/2D(phi) (this is the default behavior\n";
     std::cout << "\t-scl: computes scl(Psi_ell(C))\n";
@@ -1004,6 +1324,8 @@ int TROLLOP::trollop(int argc, char* argv[]) {
     if (argv[current_arg][1] == 'm' && argv[current_arg][2] != 'a') {
       if (argv[current_arg][2] == 'E') {
         solver = EXLP;
+      } else if (argv[current_arg][2] == 'H') {
+        solver = GLPK_EXACT;
       } else {
         if (argv[current_arg][3] == 'L') {
           solver = GLPK;
@@ -1044,6 +1366,19 @@ int TROLLOP::trollop(int argc, char* argv[]) {
     } else if (argv[current_arg][1] == 'w') {
       USE_WORDS = true;
       
+    } else if (argv[current_arg][1] == 'G') {
+      COLUMN_GENERATION = true;
+      
+    } else if (std::string(argv[current_arg]) == "-ladder") {
+      if (current_arg+1 >= argc) {
+        std::cout << "-ladder needs the last length L\n";
+        exit(1);
+      }
+      LADDER = true;
+      COLUMN_GENERATION = true;
+      ladder_top = atoi(argv[current_arg+1]);
+      current_arg++;
+      
     } else if (argv[current_arg][1] == 'L') {
       OUTPUT_PROGRAM = true;
       filename = std::string(argv[current_arg+1]);
@@ -1053,223 +1388,294 @@ int TROLLOP::trollop(int argc, char* argv[]) {
     current_arg++;
   }
   
+  if (LADDER) {
+    //the lifted triangles are all on side 0, so -dom isn't allowed either
+    if (MAT_COMP || MAT_SEPARATE_DOMAIN || OUTPUT_PROGRAM) {
+      std::cout << "-ladder can't be used with -mat, -dom or -L\n";
+      exit(1);
+    }
+    if (current_arg >= argc || atoi(argv[current_arg]) < 1
+        || ladder_top < atoi(argv[current_arg])) {
+      std::cout << "usage: ./scallop -train -ladder L [options] <length> <chain>, with L >= length >= 1\n";
+      exit(1);
+    }
+  }
+  
   if (MAT_COMP) {
     rank = atoi(argv[current_arg]);
     current_arg++;
   } else {
     rank = chain_rank(argc-current_arg-1, &argv[current_arg+1]);
   }
-  WordTable WT(rank, atoi(argv[current_arg]), DO_SUP || MAT_COMP);
-  WVec C;
-  std::vector<std::vector<int> > M;
-  std::vector<std::vector<int> > N;
-  std::vector<int> b;
+  int first_ell = atoi(argv[current_arg]);
+  int last_ell = (LADDER ? ladder_top : first_ell);
+  int length_arg = current_arg;
+  //the triangles (by the words at their vertices) in the last optimum
+  std::vector<std::vector<std::string> > support(0);
+  Rational previous_ans;
+  for (int ell=first_ell; ell<=last_ell; ell++) {
+    current_arg = length_arg;
+    WordTable WT(rank, ell, DO_SUP || MAT_COMP);
+    WVec C;
+    std::vector<std::vector<int> > M;
+    std::vector<std::vector<int> > N;
+    std::vector<int> b;
   
-  current_arg++;
+    current_arg++;
   
-  if (VERBOSE > 1) {
-    std::cout << "Working word length: " << WT.ell << "\n";
-    if (VERBOSE > 2) {
-      WT.print();
+    if (VERBOSE > 1) {
+      std::cout << "Working word length: " << WT.ell << "\n";
+      if (VERBOSE > 2) {
+        WT.print();
+      }
     }
-  }
   
   
-  if (MAT_COMP) {
-    //we still need to do this, just to create the homology info
-    WT.create_index_assignments(C);
-    //load the matrices
-    read_matrix(M, M_filename, WT, true, VERBOSE);
-    read_matrix(N, N_filename, WT, false, VERBOSE);
-    read_vector(b, b_filename, VERBOSE);
+    if (MAT_COMP) {
+      //we still need to do this, just to create the homology info
+      WT.create_index_assignments(C);
+      //load the matrices
+      read_matrix(M, M_filename, WT, true, VERBOSE);
+      read_matrix(N, N_filename, WT, false, VERBOSE);
+      read_vector(b, b_filename, VERBOSE);
     
-  } else {
-    //if we're computing null scl, then we don't need all this
+    } else {
+      //if we're computing null scl, then we don't need all this
     
-    C =  WVec(WT, &argv[current_arg], argc-current_arg, USE_WORDS);   //process the chain argument
+      C =  WVec(WT, &argv[current_arg], argc-current_arg, USE_WORDS);   //process the chain argument
     
-    //exit(0);
+      //exit(0);
     
-    if (VERBOSE>1) {
-      std::cout << "Input vector: " << C << "\n";
-      std::cout.flush();
-    }
+      if (VERBOSE>1) {
+        std::cout << "Input vector: " << C << "\n";
+        std::cout.flush();
+      }
     
-    //exit(0);
+      //exit(0);
     
-    WT.create_index_assignments(C); //assign working indices to words (edges and vertices)
+      WT.create_index_assignments(C); //assign working indices to words (edges and vertices)
     
-    if (VERBOSE>1) {
-      std::cout << "Made index assignments:\n";
-      WT.print();
-    }  
+      if (VERBOSE>1) {
+        std::cout << "Made index assignments:\n";
+        WT.print();
+      }  
     
-    //exit(0);
+      //exit(0);
     
-    C.fill_index_coefficients(WT);   //create the vector of edges from C
+      C.fill_index_coefficients(WT);   //create the vector of edges from C
     
-    if (VERBOSE>2) {
-      std::cout << "Got the vector of edges from the input vector:\n";
-      for (i=0; i<WT.num_edges; i++) {
-        std::cout << C.index_coefficients[i] << " ";
+      if (VERBOSE>2) {
+        std::cout << "Got the vector of edges from the input vector:\n";
+        for (i=0; i<WT.num_edges; i++) {
+          std::cout << C.index_coefficients[i] << " ";
+        }
+        std::cout << "\n";
       }
-      std::cout << "\n";
     }
-  }
   
-  //exit(0);
+    //exit(0);
   
-  ArcPairList AL(WT, num_copies);
-  if (VERBOSE > 1) {
-    std::cout << "computed arcs (" << AL.num_arcs << ")\n";
-    if (VERBOSE > 2) {
-      AL.print(std::cout);
+    STATS::phase("arcs");
+    ArcPairList AL(WT, num_copies);
+    if (VERBOSE > 1) {
+      std::cout << "computed arcs (" << AL.num_arcs << ")\n";
+      if (VERBOSE > 2) {
+        AL.print(std::cout);
+      }
     }
-  }
   
-  //exit(0);
+    //exit(0);
   
-  std::vector<Triangle> TR(0);
-  compute_triangles(WT, AL, num_copies, TR);
-  if (VERBOSE > 1) {
-    std::cout << "computed triangles (" << TR.size() << ")\n"; std::cout.flush();
-    if (VERBOSE > 2) {
-      print_triangles(TR, std::cout);
+    STATS::phase("polygons");
+    std::vector<Triangle> TR(0);
+    if (COLUMN_GENERATION && OUTPUT_PROGRAM) {
+      std::cout << "Column generation doesn't write the linear program; ignoring -G\n";
+      COLUMN_GENERATION = false;
+    }
+    if (!COLUMN_GENERATION) {
+      compute_triangles(WT, AL, num_copies, TR);
+    }
+    if (VERBOSE > 1 && !COLUMN_GENERATION) {
+      std::cout << "computed triangles (" << TR.size() << ")\n"; std::cout.flush();
+      if (VERBOSE > 2) {
+        print_triangles(TR, std::cout);
+      }
     }
-  }
   
-  //exit(0);
+    //exit(0);
   
-  std::vector<Rectangle> RE;
-  compute_rectangles(WT, AL, num_copies, RE);
-  if (VERBOSE > 1) {
-    std::cout << "computed rectangles (" << RE.size() << ")\n"; std::cout.flush();
-    if (VERBOSE > 2) {
-      print_rectangles(RE, std::cout);
+    std::vector<Rectangle> RE;
+    compute_rectangles(WT, AL, num_copies, RE);
+    if (VERBOSE > 1) {
+      std::cout << "computed rectangles (" << RE.size() << ")\n"; std::cout.flush();
+      if (VERBOSE > 2) {
+        print_rectangles(RE, std::cout);
+      }
     }
-  }
   
-  //exit(0);
+    //exit(0);
   
   
-  if (OUTPUT_PROGRAM) {
-    write_lp(WT, C, AL, num_copies, TR, RE, DO_SUP, MAT_COMP, MAT_SEPARATE_DOMAIN, M, N, b, VERBOSE, LP_VERBOSE, filename);
-    if (VERBOSE>0) {
-      std::cout << "Wrote linear program\n";
-    }
-  } else {
+    STATS::phase("lp_setup");
+    if (OUTPUT_PROGRAM) {
+      write_lp(WT, C, AL, num_copies, TR, RE, DO_SUP, MAT_COMP, MAT_SEPARATE_DOMAIN, M, N, b, VERBOSE, LP_VERBOSE, filename);
+      if (VERBOSE>0) {
+        std::cout << "Wrote linear program\n";
+      }
+    } else {
 
-    Rational ans;
-    std::vector<Rational> solution_vector(0);                           //run the LP
+      Rational ans;
+      std::vector<Rational> solution_vector(0);                           //run the LP
     
-    trollop_lp(WT, C, AL, num_copies, TR, RE, DO_SUP,
-               MAT_COMP,
-               MAT_SEPARATE_DOMAIN,
-               M, N, b,
-              ans, 
-              solution_vector, 
-              solver,
-              VERBOSE,
-              LP_VERBOSE); 
-    
-    if (VERBOSE>0) {
-        //output for supremum
-      if (DO_SUP) {
-        std::cout << "sup_{Q_" << WT.ell << "} phi(C)/2D(phi) = " 
-                  << "inf_t(w + tE) = (t->" <<  solution_vector[solution_vector.size()-1] 
-                  << "); " << ans << " = " << ans.get_d() << "\n";
-        if (VERBOSE > 1) {
-          std::cout << "t = " << solution_vector[solution_vector.size()-1] << "\n"; 
+      if (COLUMN_GENERATION) {
+        std::vector<std::vector<int> > warm_start(0);
+        if (LADDER) {
+          lift_triangles(WT, support, warm_start);
         }
-        
-        //output for MAT_COMP
-      } else if (MAT_COMP) {
-        if (MAT_SEPARATE_DOMAIN) {
-          std::vector<std::vector<Rational> > weight_vector;
-          weight_vector.resize(num_copies);
-          for (i=0; i<num_copies; i++) {
-            weight_vector[i].resize(WT.num_edges);
+        trollop_lp_column_generation(WT, C, AL, num_copies, TR, RE, DO_SUP,
+                                     MAT_COMP,
+                                     MAT_SEPARATE_DOMAIN,
+                                     M, N, b,
+                                     ans,
+                                     solution_vector,
+                                     solver,
+                                     VERBOSE,
+                                     LP_VERBOSE,
+                                     (LADDER ? &warm_start : NULL));
+      } else {
+        trollop_lp(WT, C, AL, num_copies, TR, RE, DO_SUP,
+                   MAT_COMP,
+                   MAT_SEPARATE_DOMAIN,
+                   M, N, b,
+                  ans, 
+                  solution_vector, 
+                  NULL,
+                  NULL,
+                  solver,
+                  VERBOSE,
+                  LP_VERBOSE); 
+      }
+    
+      STATS::phase("output");
+      if (VERBOSE>0) {
+          //output for supremum
+        if (DO_SUP) {
+          std::cout << "sup_{Q_" << WT.ell << "} phi(C)/2D(phi) = " 
+                    << "inf_t(w + tE) = (t->" <<  solution_vector[solution_vector.size()-1] 
+                    << "); " << ans << " = " << ans.get_d() << "\n";
+          if (VERBOSE > 1) {
+            std::cout << "t = " << solution_vector[solution_vector.size()-1] << "\n"; 
           }
-          for (i=0; i<WT.num_edges; i++) {
-            weight_vector[0][i] = solution_vector[RE.size() + TR.size() + i];
-            weight_vector[1][i] = solution_vector[RE.size() + TR.size() + WT.num_edges + i];
-          }          
-          std::cout << "Min side 0 (input weight x): ";
-          for (i=0; i<(int)weight_vector[0].size(); i++) {
-            std::string temp;
-            if (weight_vector[0][i] > 0) {
-              WT.get_word(temp, WT.ell, i);
-              std::cout << weight_vector[0][i] << temp << " ";
+        
+          //output for MAT_COMP
+        } else if (MAT_COMP) {
+          if (MAT_SEPARATE_DOMAIN) {
+            std::vector<std::vector<Rational> > weight_vector;
+            weight_vector.resize(num_copies);
+            for (i=0; i<num_copies; i++) {
+              weight_vector[i].resize(WT.num_edges);
             }
-          }
-          std::cout << "\n" << "Min side 1 (phi(x)): ";
-          for (i=0; i<(int)weight_vector[1].size(); i++) {
-            std::string temp;
-            if (weight_vector[1][i] > 0) {
-              WT.get_word(temp, WT.ell, i);
-              std::cout << weight_vector[1][i] << temp << " ";
+            for (i=0; i<WT.num_edges; i++) {
+              weight_vector[0][i] = solution_vector[RE.size() + TR.size() + i];
+              weight_vector[1][i] = solution_vector[RE.size() + TR.size() + WT.num_edges + i];
+            }          
+            std::cout << "Min side 0 (input weight x): ";
+            for (i=0; i<(int)weight_vector[0].size(); i++) {
+              std::string temp;
+              if (weight_vector[0][i] > 0) {
+                WT.get_word(temp, WT.ell, i);
+                std::cout << weight_vector[0][i] << temp << " ";
+              }
             }
-          }
-          std::cout << "\nwith scl = " << ans << " = " << ans.get_d() << "\n";
+            std::cout << "\n" << "Min side 1 (phi(x)): ";
+            for (i=0; i<(int)weight_vector[1].size(); i++) {
+              std::string temp;
+              if (weight_vector[1][i] > 0) {
+                WT.get_word(temp, WT.ell, i);
+                std::cout << weight_vector[1][i] << temp << " ";
+              }
+            }
+            std::cout << "\nwith scl = " << ans << " = " << ans.get_d() << "\n";
           
-        } else {
-          std::vector<Rational> weight_vector(WT.num_edges);
-          std::vector<Rational> input_weight_vector(WT.num_edges);
-          for (i=0; i<(int)weight_vector.size(); i++) {
-            weight_vector[i] = Rational(0,1);
-            input_weight_vector[i] = Rational(0,1);
-          }
-          for (i=0; i<(int)RE.size(); i++) {
-            if (solution_vector[i] > 0) {
-              weight_vector[RE[i].e0] = weight_vector[RE[i].e0] + solution_vector[i];
-              weight_vector[RE[i].e1] = weight_vector[RE[i].e1] + solution_vector[i];
+          } else {
+            std::vector<Rational> weight_vector(WT.num_edges);
+            std::vector<Rational> input_weight_vector(WT.num_edges);
+            for (i=0; i<(int)weight_vector.size(); i++) {
+              weight_vector[i] = Rational(0,1);
+              input_weight_vector[i] = Rational(0,1);
             }
-          }
-          for (i=0; i<WT.num_edges; i++) {
-            input_weight_vector[i] = solution_vector[RE.size() + TR.size() + i];
-          }
-          std::cout << "Min weight (i.e. partial S): ";
-          for (i=0; i<(int)weight_vector.size(); i++) {
-            std::string temp;
-            if (weight_vector[i] > 0) {
-              WT.get_word(temp, WT.ell, i);
-              std::cout << weight_vector[i] << temp << " ";
+            for (i=0; i<(int)RE.size(); i++) {
+              if (solution_vector[i] > 0) {
+                weight_vector[RE[i].e0] = weight_vector[RE[i].e0] + solution_vector[i];
+                weight_vector[RE[i].e1] = weight_vector[RE[i].e1] + solution_vector[i];
+              }
+            }
+            for (i=0; i<WT.num_edges; i++) {
+              input_weight_vector[i] = solution_vector[RE.size() + TR.size() + i];
+            }
+            std::cout << "Min weight (i.e. partial S): ";
+            for (i=0; i<(int)weight_vector.size(); i++) {
+              std::string temp;
+              if (weight_vector[i] > 0) {
+                WT.get_word(temp, WT.ell, i);
+                std::cout << weight_vector[i] << temp << " ";
+              }
+            }
+            std::cout << "\nwith scl = " << ans << " = " << ans.get_d() << "\n";
+            std::cout << "Min input weight (the x in partial S = Mx): ";
+            for (i=0; i<(int)input_weight_vector.size(); i++) {
+              std::string temp;
+              if (input_weight_vector[i] > 0) {
+                WT.get_word(temp, WT.ell, i);
+                std::cout << input_weight_vector[i] << temp << " ";
+              }
             }
+            std::cout << "\n";
           }
-          std::cout << "\nwith scl = " << ans << " = " << ans.get_d() << "\n";
-          std::cout << "Min input weight (the x in partial S = Mx): ";
-          for (i=0; i<(int)input_weight_vector.size(); i++) {
-            std::string temp;
-            if (input_weight_vector[i] > 0) {
-              WT.get_word(temp, WT.ell, i);
-              std::cout << input_weight_vector[i] << temp << " ";
+          //output for scl 
+        } else {
+          std::cout << "scl( ";
+          C.print_words(std::cout);
+          std::cout << ") = " << ans << " = " << ans.get_d() << "\n";    //output the answer
+        }
+      
+        if (VERBOSE > 1){// && (int)solution_vector.size() < 1000) {
+          for (i=0; i<(int)solution_vector.size()-1; i++) {
+            if (solution_vector[i] > 0 && i < (int)RE.size() + (int)TR.size()) { 
+              if (i < (int)RE.size()) {
+                std::cout << solution_vector[i] << " * " << RE[i] << "\n";
+              } else {
+                std::cout << solution_vector[i] << " * " << TR[i-(int)RE.size()] << "\n";
+              }
             }
           }
-          std::cout << "\n";
         }
-        //output for scl 
       } else {
-        std::cout << "scl( ";
-        C.print_words(std::cout);
-        std::cout << ") = " << ans << " = " << ans.get_d() << "\n";    //output the answer
+        std::cout << ans.get_d() << "\n";
       }
-      
-      if (VERBOSE > 1){// && (int)solution_vector.size() < 1000) {
-        for (i=0; i<(int)solution_vector.size()-1; i++) {
-          if (solution_vector[i] > 0 && i < (int)RE.size() + (int)TR.size()) { 
-            if (i < (int)RE.size()) {
-              std::cout << solution_vector[i] << " * " << RE[i] << "\n";
-            } else {
-              std::cout << solution_vector[i] << " * " << TR[i-(int)RE.size()] << "\n";
-            }
+    
+      if (LADDER) {
+        //the next length starts from the triangles used here
+        support.resize(0);
+        for (i=0; i<(int)TR.size() && (int)RE.size()+i < (int)solution_vector.size(); i++) {
+          if (solution_vector[RE.size()+i] > 0) {
+            std::vector<std::string> T(3);
+            WT.get_word(T[0], WT.ell-1, TR[i].v0);
+            WT.get_word(T[1], WT.ell-1, TR[i].v1);
+            WT.get_word(T[2], WT.ell-1, TR[i].v2);
+            support.push_back(T);
           }
         }
+        if (VERBOSE > 0 && ell > first_ell) {
+          std::cout << "(length " << ell << "; change from length " << ell-1 
+                    << ": " << ans - previous_ans << ")\n";
+        }
+        previous_ans = ans;
+        std::cout.flush();
       }
-    } else {
-      std::cout << ans.get_d() << "\n";
     }
     
   }
-    
+  
   return 0;
 }
@@ -4,6 +4,9 @@
 #include "../rational.h"
 #include "../lp.h"
 
+//the most triangles added in one round of column generation (-G)
+#define TROLLOP_MAX_PRICED_TRIANGLES 2000
+
 namespace TROLLOP {
 
   void read_matrix(std::vector<std::vector<int> >& matrix, 
@@ -39,6 +42,7 @@ namespace TROLLOP {
                                     std::vector<int> &ia,
                                     std::vector<int> &ja,
                                     std::vector<int> &ar,
+                                    SparseAccumulator<int> &accumulator,
                            int VERBOSE);
 
   void write_lp(WordTable& WT, 
@@ -71,10 +75,31 @@ namespace TROLLOP {
                   std::vector<int>& b,
                   Rational& ans,
                   std::vector<Rational>& solution_vector,
+                  std::vector<Rational>* dual_vector,
+                  std::vector<double>* double_dual_vector,
                   SparseLPSolver solver,
                   int VERBOSE,
                   int LP_VERBOSE);
   
+  void trollop_lp_column_generation(WordTable& WT, 
+                                    WVec& C, 
+                                    ArcPairList& AL, 
+                                    int num_copies,
+                                    std::vector<Triangle>& TR, 
+                                    std::vector<Rectangle>& RE, 
+                                    bool DO_SUP,
+                                    bool MAT_COMP,
+                                    bool MAT_SEPARATE_DOMAIN,
+                                    std::vector<std::vector<int> >& M,
+                                    std::vector<std::vector<int> >& N,
+                                    std::vector<int>& b,
+                                    Rational& ans,
+                                    std::vector<Rational>& solution_vector,
+                                    SparseLPSolver solver,
+                                    int VERBOSE,
+                                    int LP_VERBOSE,
+                                    std::vector<std::vector<int> >* warm_start);
+  
   int trollop(int argc, char* argv[]);
 
 
@@ -2,6 +2,7 @@
 #include <iostream>
 #include <string>
 #include <utility>
+#include <algorithm>
 
 #include <ctype.h>
 #include <stdlib.h>
@@ -135,6 +136,59 @@ void TROLLOP::int_to_word(std::string &S, int n, int rank) {
 
 
 
+/****************************************************************************
+ IndexTable methods
+ *****************************************************************************/
+IndexTable::IndexTable() {
+  keys = std::vector<int>(16, -1);
+  values = std::vector<int>(16, 0);
+  num_entries = 0;
+}
+
+//the capacity is a power of 2, so the slot is the middle bits of a 
+//multiplicative hash, masked
+static int index_table_slot(int key, int capacity) {
+  return (int)(((unsigned long long)key * 0x9E3779B97F4A7C15ull) >> 32) & (capacity-1);
+}
+
+void IndexTable::insert(int key, int value) {
+  int i;
+  if (2*(num_entries+1) > (int)keys.size()) {
+    std::vector<int> old_keys(2*keys.size(), -1);
+    std::vector<int> old_values(2*keys.size(), 0);
+    old_keys.swap(keys);
+    old_values.swap(values);
+    num_entries = 0;
+    for (i=0; i<(int)old_keys.size(); i++) {
+      if (old_keys[i] != -1) {
+        insert(old_keys[i], old_values[i]);
+      }
+    }
+  }
+  i = index_table_slot(key, keys.size());
+  while (keys[i] != -1 && keys[i] != key) {
+    i = (i+1) & ((int)keys.size()-1);
+  }
+  if (keys[i] == -1) {
+    keys[i] = key;
+    num_entries++;
+  }
+  values[i] = value;
+}
+
+int IndexTable::find(int key) {
+  int i = index_table_slot(key, keys.size());
+  while (keys[i] != -1) {
+    if (keys[i] == key) {
+      return values[i];
+    }
+    i = (i+1) & ((int)keys.size()-1);
+  }
+  return -1;
+}
+
+
+
 /****************************************************************************
  WordTable methods
  *****************************************************************************/
@@ -154,8 +208,8 @@ WordTable::WordTable(int R, int L, bool DO_SUP) {
     num_verts = num_real_verts;
     num_edges = num_real_edges;
   }
-  vertex_to_index = std::vector<int>(0);
-  edge_to_index = std::vector<int>(0);
+  vertex_to_index = IndexTable();
+  edge_to_index = IndexTable();
   index_to_vertex = std::vector<int>(0);
   index_to_edge = std::vector<int>(0);
   h_vector = std::vector<std::vector<int> >(0);
@@ -163,53 +217,50 @@ WordTable::WordTable(int R, int L, bool DO_SUP) {
 
 
 void WordTable::create_index_assignments(WVec &C) {
-  int current_val;
-  int i;
-  int h_val;
+  int i, h;
   
   h_vector = std::vector<std::vector<int> > (2*rank, std::vector<int>(0));
   
   if (do_sup) {
-    //do no assignments
-    for (i=0; i<num_real_edges; i++) {
-      h_val = letter_to_number(get_h_from_real_index(i), rank, '\0');
-      h_vector[h_val].push_back(i);
+    //do no assignments; the edges with a given h are a block of real indices
+    for (h=0; h<2*rank; h++) {
+      h_vector[h].resize(first_letter_offset_edges);
+      for (i=0; i<first_letter_offset_edges; i++) {
+        h_vector[h][i] = h*first_letter_offset_edges + i;
+      }
     }
     num_edges = num_real_edges;
     num_verts = num_real_verts;
   } else {
     //go through the words which appear in C, and 
-    //give them indices, and that's it
-    edge_to_index = std::vector<int> (num_real_edges, 0);
-    vertex_to_index = std::vector<int> (num_real_verts, 0);
+    //give them indices (in order of real index), and that's it; 
+    //the rest of the word space is never touched
+    index_to_edge = std::vector<int>(0);
+    index_to_vertex = std::vector<int>(0);
     for (i=0; i<(int)C.word_list.size(); i++) {
-      edge_to_index[ C.word_list[i].second ] = -1;
-      vertex_to_index[ get_real_edge_dest(C.word_list[i].second) ] = -1;
-      vertex_to_index[ get_real_edge_source(C.word_list[i].second) ] = -1;
+      index_to_edge.push_back(C.word_list[i].second);
+      index_to_vertex.push_back(get_real_edge_dest(C.word_list[i].second));
+      index_to_vertex.push_back(get_real_edge_source(C.word_list[i].second));
     }
-    current_val = 0;
-    index_to_edge = std::vector<int>(0);
-    for (i=0; i<num_real_edges; i++) {
-      if (edge_to_index[i] == -1) {
-        edge_to_index[i] = current_val;
-        index_to_edge.push_back(i);
-        h_val = letter_to_number(get_h_from_real_index(i), rank, '\0');
-        h_vector[h_val].push_back(current_val);
-        current_val++;
-      }
+    std::sort(index_to_edge.begin(), index_to_edge.end());
+    index_to_edge.erase(std::unique(index_to_edge.begin(), index_to_edge.end()), 
+                        index_to_edge.end());
+    std::sort(index_to_vertex.begin(), index_to_vertex.end());
+    index_to_vertex.erase(std::unique(index_to_vertex.begin(), index_to_vertex.end()), 
+                          index_to_vertex.end());
+    
+    edge_to_index = IndexTable();
+    for (i=0; i<(int)index_to_edge.size(); i++) {
+      edge_to_index.insert(index_to_edge[i], i);
+      h_vector[index_to_edge[i] / first_letter_offset_edges].push_back(i);
     }
-    num_edges = current_val;
+    num_edges = index_to_edge.size();
     
-    current_val = 0;
-    index_to_vertex = std::vector<int>(0);
-    for (i=0; i<num_real_verts; i++) {
-      if (vertex_to_index[i] == -1) {
-        vertex_to_index[i] = current_val;
-        index_to_vertex.push_back(i);
-        current_val++;
-      }
+    vertex_to_index = IndexTable();
+    for (i=0; i<(int)index_to_vertex.size(); i++) {
+      vertex_to_index.insert(index_to_vertex[i], i);
     }
-    num_verts = current_val;
+    num_verts = index_to_vertex.size();
     
   }
   have_assigned_indices = true;
@@ -328,9 +379,9 @@ int WordTable::get_index(std::string &S) {
     return get_real_index(S);
   } else {
     if ((int)S.size() == ell) { 
-      return edge_to_index[get_real_index(S)];
+      return edge_to_index.find(get_real_index(S));
     } else {
-      return vertex_to_index[get_real_index(S)];
+      return vertex_to_index.find(get_real_index(S));
     }
   }
 }
@@ -357,7 +408,7 @@ int WordTable::get_edge_dest(int index) {
   if (do_sup) {
     return get_real_edge_dest(index);
   } else {
-    return vertex_to_index[get_real_edge_dest(index_to_edge[index])];
+    return vertex_to_index.find(get_real_edge_dest(index_to_edge[index]));
   }
 }
 
@@ -365,7 +416,7 @@ int WordTable::get_edge_source(int index) {
   if (do_sup) {
     return get_real_edge_source(index);
   } else {
-    return vertex_to_index[get_real_edge_source(index_to_edge[index])];
+    return vertex_to_index.find(get_real_edge_source(index_to_edge[index]));
   }
 }
   
@@ -473,7 +524,7 @@ void WVec::fill_index_coefficients(WordTable &WT) {
     if (WT.do_sup) {
       index_coefficients[ word_list[i].second ] += word_list[i].first;
     } else {
-      index_coefficients[ WT.edge_to_index[word_list[i].second] ] += word_list[i].first;
+      index_coefficients[ WT.edge_to_index.find(word_list[i].second) ] += word_list[i].first;
     }
   }
   
@@ -507,56 +558,45 @@ std::ostream& TROLLOP::operator<<(std::ostream& os, WVec& C) {
 /***************************************************************************
  ArcPairList methods
  **************************************************************************/
- //simply go through all vertices and make all pairs
-ArcPairList::ArcPairList(WordTable &WT, int num_copies) {
-  int i,j,sidea,sideb;
-  num_arcs = -500000;
-  arc_list.resize(0);
-  arcs_beginning_with.resize(num_copies);
-  for (i=0; i<num_copies; i++) {
-    arcs_beginning_with[i].resize(WT.num_verts);
-  }
-  for (sidea=0; sidea<num_copies; sidea++) {
-    for (i=0; i<WT.num_verts; i++) {
-      arcs_beginning_with[sidea][i].resize(0);
-      for (sideb=sidea; sideb<num_copies; sideb++) {
-        for (j=(sidea<sideb? 0 : i+1); j<WT.num_verts; j++) {
-          arc_list.push_back( std::make_pair( std::make_pair(sidea, i), 
-                                              std::make_pair(sideb, j) ) );
-          arcs_beginning_with[sidea][i].push_back(arc_list.size()-1);
-        }
-      }
-    }
-  }
-  num_arcs = (int)arc_list.size();
+ //all pairs of vertices are arcs, so there's nothing to make
+ArcPairList::ArcPairList(WordTable &WT, int nc) {
+  num_copies = nc;
+  num_verts = WT.num_verts;
+  long long n = (long long)num_copies * num_verts;
+  num_arcs = (int)(n*(n-1)/2);
 }
 
 //if a<b, this returns 1+index
 //if b<a, this returns -(1+index)
+//the arcs starting at p are preceded by those starting at 0, ..., p-1, 
+//of which there are (n-1) + ... + (n-p)
 int ArcPairList::index_of_arc(int sidea, int a, int sideb, int b) {
-  int i;
-  if (sidea < sideb || (sidea==sideb && a<b)) {
-    for (i=0; i<(int)arcs_beginning_with[sidea][a].size(); i++) {
-      if (arc_list[arcs_beginning_with[sidea][a][i]].second == std::make_pair(sideb, b) ) {
-        return 1 + arcs_beginning_with[sidea][a][i];
-      }
-    }
-  } else {
-    for (i=0; i<(int)arcs_beginning_with[sideb][b].size(); i++) {
-      if (arc_list[arcs_beginning_with[sideb][b][i]].second == std::make_pair(sidea, a) ) {
-        return -(1 + arcs_beginning_with[sideb][b][i]);
-      }
-    }    
+  long long n = (long long)num_copies * num_verts;
+  long long p = (long long)sidea * num_verts + a;
+  long long q = (long long)sideb * num_verts + b;
+  int sign = 1;
+  if (p == q) {
+    return -1;
+  } else if (q < p) {
+    std::swap(p, q);
+    sign = -1;
   }
-  return -1;
+  return sign * (int)(1 + p*(2*n-p-1)/2 + (q-p-1));
 }
 
 void ArcPairList::print(std::ostream& os) {
-  int i;
+  int i,j,sidea,sideb;
+  int k = 0;
   os << "Arc pair list: (" << num_arcs << " pairs)\n";
-  for (i=0; i<(int)arc_list.size(); i++) {
-    os << i << ": (" << arc_list[i].first.first << "-" << arc_list[i].first.second << ", " 
-                     << arc_list[i].second.first << "-" << arc_list[i].second.second << ")\n";
+  for (sidea=0; sidea<num_copies; sidea++) {
+    for (i=0; i<num_verts; i++) {
+      for (sideb=sidea; sideb<num_copies; sideb++) {
+        for (j=(sidea<sideb? 0 : i+1); j<num_verts; j++) {
+          os << k << ": (" << sidea << "-" << i << ", " << sideb << "-" << j << ")\n";
+          k++;
+        }
+      }
+    }
   }
 }
 
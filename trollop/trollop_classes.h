@@ -26,6 +26,24 @@ char number_to_letter(int n, int rank, char letter_removed);
     
 
 
+/*****************************************************************************
+ An open-addressing (linear probing) hash table from the real index of a 
+ word, i.e. its index among all the words of its length, to the index 
+ assigned to it.  Only the words which are given indices take any space, 
+ rather than the whole word space.  Keys are nonnegative; -1 marks an 
+ empty slot
+ ****************************************************************************/
+struct IndexTable {
+  std::vector<int> keys;
+  std::vector<int> values;
+  int num_entries;
+  
+  IndexTable();
+  void insert(int key, int value);
+  int find(int key);                  //-1 if the key isn't in the table
+};
+
+
 /*****************************************************************************
  This class creates a table of the words of length ell and ell-1
  (it doesn't actually create a list of all of them).  These are the vertices 
@@ -45,8 +63,8 @@ struct WordTable {
   bool do_sup;
   bool have_assigned_indices;
   std::vector<std::vector<int> > h_vector;
-  std::vector<int> vertex_to_index;
-  std::vector<int> edge_to_index;
+  IndexTable vertex_to_index;
+  IndexTable edge_to_index;
   std::vector<int> index_to_vertex;
   std::vector<int> index_to_edge;
   
@@ -94,12 +112,14 @@ std::ostream& operator<<(std::ostream& os, WVec& C);
 /****************************************************************************
  This class gives a list of pairs of arcs.  Each arc gives a pair of 
  vertices.  We have (a,b) = -(b,a), so we will only record whichever 
- is lexicographically first
+ is lexicographically first.  Every pair is an arc, so the list isn't 
+ stored: vertex i on side s is number s*num_verts+i, and the arcs are 
+ the pairs p<q of these numbers, in lexicographic order
  ****************************************************************************/
 struct ArcPairList {
   int num_arcs;
-  std::vector<std::pair<std::pair<int, int>, std::pair<int, int> > > arc_list;
-  std::vector<std::vector<std::vector<int> > > arcs_beginning_with;
+  int num_copies;
+  int num_verts;
   
   ArcPairList(WordTable &WT, int num_copies);
   int index_of_arc(int side_a, int a, int side_b, int b);
@@ -42,29 +42,29 @@ string inverse(string& s) {
 }
 
 void red(string& s) {			// reduce by cancelling adjacent inverse letters
-	int i,a,b;
-	i=0;
-	while(i<=(int) s.length()){
-		if(i>0){
-			a = (int) s[i-1];
-			b = (int) s[i];
-			if((32+a-b)%64==0){
-	//			cout << (*s) << " " << i << "\n";
-				s.erase(i-1,2);
-	//			cout << (*s) << "\n";
-				i=i-2;
-			};
-		};
-		i++;
-	};
-	return;
-};
+  //s[0..top) is reduced, so it works as a stack
+  int top = 0;
+  int sl = s.size();
+  for (int i=0; i<sl; i++) {
+    if (top > 0 && (32+(int)s[top-1]-(int)s[i])%64 == 0) {
+      top--;
+    } else {
+      s[top++] = s[i];
+    }
+  }
+  s.resize(top);
+}
 
 
+//cancel matching letters off the two ends (s must already be reduced)
 void cyc_red(string& s) {
-  while ( (s.size() > 0) && (s[0] == swapCaseChar(s[s.size()-1])) ) {
-    s.erase(0,1);
-    s.erase(s.size()-1, 1);
+  int sl = s.size();
+  int k = 0;
+  while (k < sl-1-k && s[k] == swapCaseChar(s[sl-1-k])) {
+    k++;
+  }
+  if (k > 0) {
+    s = s.substr(k, sl-2*k);
   }
 }
 